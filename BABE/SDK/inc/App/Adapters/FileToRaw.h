@@ -1,44 +1,67 @@
 #pragma once
 #include "App/Classes/File.h"
-#include "Helper/BE.h"
+#include "Helper/WireCodec.h"
 #include <cstdint>
 #include <cstring>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+#include <sys/uio.h>
 
 struct RawFile{
     uint8_t* content;
     uint64_t size;
 };
 
-inline auto toRaw(const File& file){
-    uint16_t filenameSize = file.filename.size();
-    uint16_t extensionSize = file.extension.size();
-    uint64_t fileSize = file.size;
+// Serialized file header, big-endian:
+// [u16 filename size][filename][u16 extension size][extension][u64 file size]
+struct RawHeaderLayout{
+    using FilenameSize = WireField<uint16_t, 0>;
+    static constexpr size_t fixedBytes = 2 + 2 + 8;
 
-    // Convert to big endian
-    BE16(filenameSize);
-    BE16(extensionSize);
-    BE64(fileSize);
-
-    uint64_t totalBytes = 2 + file.filename.size() + 2 + file.extension.size() + 8 + file.size;
-    uint8_t* serialized = new uint8_t[totalBytes];
-    uint8_t* ptr = serialized;
-
-    memcpy(ptr, &filenameSize, 2);
-    ptr += 2;
+    static constexpr size_t size(size_t filenameSize, size_t extensionSize){
+        return fixedBytes + filenameSize + extensionSize;
+    }
+    static constexpr size_t extensionSizeOffset(size_t filenameSize){ return 2 + filenameSize; }
+    static constexpr size_t fileSizeOffset(size_t filenameSize, size_t extensionSize){
+        return 4 + filenameSize + extensionSize;
+    }
+};
 
-    memcpy(ptr, file.filename.c_str(), file.filename.size());
-    ptr += file.filename.size();
+// Names and extensions are length-prefixed with a u16; longer ones cannot
+// be represented and are rejected rather than truncated.
+inline bool rawHeaderEncodable(const File& file){
+    return file.filename.size() <= std::numeric_limits<uint16_t>::max()
+        && file.extension.size() <= std::numeric_limits<uint16_t>::max();
+}
 
-    memcpy(ptr, &extensionSize, 2);
-    ptr += 2;
+inline size_t rawHeaderSize(const File& file){
+    return RawHeaderLayout::size(file.filename.size(), file.extension.size());
+}
 
-    memcpy(ptr, file.extension.c_str(), file.extension.size());
-    ptr += file.extension.size();
+// file must be rawHeaderEncodable(); out must hold rawHeaderSize(file) bytes.
+inline void encodeRawHeader(const File& file, uint8_t* out){
+    size_t filenameSize = file.filename.size();
+    size_t extensionSize = file.extension.size();
+    RawHeaderLayout::FilenameSize::set(out, static_cast<uint16_t>(filenameSize));
+    memcpy(out + 2, file.filename.data(), filenameSize);
+    storeBE<uint16_t>(out + RawHeaderLayout::extensionSizeOffset(filenameSize), static_cast<uint16_t>(extensionSize));
+    memcpy(out + RawHeaderLayout::extensionSizeOffset(filenameSize) + 2, file.extension.data(), extensionSize);
+    storeBE<uint64_t>(out + RawHeaderLayout::fileSizeOffset(filenameSize, extensionSize), file.size);
+}
 
-    memcpy(ptr, &fileSize, 8);
-    ptr += 8;
+// Returns nullptr if the header is not encodable.
+inline RawFile* toRaw(const File& file){
+    if(!rawHeaderEncodable(file)){
+        return nullptr;
+    }
+    uint64_t headerBytes = rawHeaderSize(file);
+    uint64_t totalBytes = headerBytes + file.size;
+    uint8_t* serialized = new uint8_t[totalBytes];
 
-    memcpy(ptr, file.data, file.size);
+    encodeRawHeader(file, serialized);
+    memcpy(serialized + headerBytes, file.data, file.size);
 
     RawFile* serial = new RawFile();
     serial->content = serialized;
@@ -47,3 +70,113 @@ inline auto toRaw(const File& file){
 
     return serial;
 }
+
+// Header storage that survives between transfers so its capacity is reused.
+struct RawHeaderBuffer{
+    std::vector<uint8_t> storage;
+};
+
+// Scatter-gather form of RawFile: [header][payload], where the payload is
+// borrowed from the File and must outlive the view. The header is owned by
+// the view and handed back to its RawHeaderBuffer on destruction. A file
+// whose header is not encodable yields an empty, invalid view.
+class RawFileView{
+public:
+    RawFileView(RawHeaderBuffer& home, const File& file)
+        : home_(&home), header_(std::move(home.storage)){
+        if(!rawHeaderEncodable(file)){
+            header_.clear();
+            parts_[0] = {nullptr, 0};
+            parts_[1] = {nullptr, 0};
+            size_ = 0;
+            valid_ = false;
+            return;
+        }
+        header_.resize(rawHeaderSize(file));
+        encodeRawHeader(file, header_.data());
+
+        parts_[0] = {header_.data(), header_.size()};
+        parts_[1] = {file.data, file.size};
+        size_ = header_.size() + file.size;
+    }
+
+    RawFileView(RawFileView&& other) noexcept
+        : home_(std::exchange(other.home_, nullptr)),
+          header_(std::move(other.header_)),
+          size_(other.size_),
+          valid_(other.valid_){
+        parts_[0] = other.parts_[0];
+        parts_[1] = other.parts_[1];
+    }
+
+    RawFileView& operator=(RawFileView&& other) noexcept{
+        if(this != &other){
+            release();
+            home_ = std::exchange(other.home_, nullptr);
+            header_ = std::move(other.header_);
+            parts_[0] = other.parts_[0];
+            parts_[1] = other.parts_[1];
+            size_ = other.size_;
+            valid_ = other.valid_;
+        }
+        return *this;
+    }
+
+    RawFileView(const RawFileView&) = delete;
+    RawFileView& operator=(const RawFileView&) = delete;
+
+    ~RawFileView(){ release(); }
+
+    bool valid() const{ return valid_; }
+    const iovec* iov() const{ return parts_; }
+    int iovcnt() const{ return parts_[1].iov_len ? 2 : 1; }
+    uint64_t size() const{ return size_; }
+
+    std::span<const uint8_t> header() const{ return {header_.data(), header_.size()}; }
+    std::span<const uint8_t> payload() const{
+        return {static_cast<const uint8_t*>(parts_[1].iov_base), parts_[1].iov_len};
+    }
+
+private:
+    void release(){
+        if(home_){
+            home_->storage = std::move(header_);
+            home_ = nullptr;
+        }
+    }
+
+    RawHeaderBuffer* home_;
+    std::vector<uint8_t> header_;
+    iovec parts_[2];
+    uint64_t size_;
+    bool valid_ = true;
+};
+
+// Zero-copy counterpart of toRaw(): only the header is serialized.
+inline RawFileView toRawView(const File& file, RawHeaderBuffer& header){
+    return RawFileView(header, file);
+}
+
+// Reads the fields written by toRaw()/toRawView() back into file; data is
+// left untouched. Returns false if the header is truncated.
+inline bool parseRawHeader(std::span<const uint8_t> header, File& file){
+    if(header.size() < RawHeaderLayout::fixedBytes){
+        return false;
+    }
+    const uint8_t* in = header.data();
+    size_t filenameSize = RawHeaderLayout::FilenameSize::get(in);
+    if(header.size() < RawHeaderLayout::size(filenameSize, 0)){
+        return false;
+    }
+    size_t extensionSize = loadBE<uint16_t>(in + RawHeaderLayout::extensionSizeOffset(filenameSize));
+    if(header.size() < RawHeaderLayout::size(filenameSize, extensionSize)){
+        return false;
+    }
+
+    // Length is validated; everything below reads at known offsets.
+    file.filename.assign(reinterpret_cast<const char*>(in + 2), filenameSize);
+    file.extension.assign(reinterpret_cast<const char*>(in + RawHeaderLayout::extensionSizeOffset(filenameSize) + 2),
+                          extensionSize);
+    file.size = loadBE<uint64_t>(in + RawHeaderLayout::fileSizeOffset(filenameSize, extensionSize));
+    return true;
+}
@@ -1,9 +1,22 @@
 #pragma once
 #include <cstdint>
 #include <stddef.h>
+#include "Classes/ChunkHeader.h"
 #include "Classes/MessageChunksList.h"
 #include "Classes/File.h"
+#include "Chunking/Chunker.h"
+#include "Streaming/ChunkStream.h"
+#include "Streaming/MappedFileSource.h"
 
-MessageChunksList* sendData(File& file, uint8_t senderID, uint8_t receiverID);
+// Splits file into MTU-sized chunks (see chunkAt()). The header chunks own a
+// copy of the serialized header; the data chunks borrow file.data, which
+// must stay alive as long as the returned list. The list is empty if the
+// file cannot be chunked at this MTU.
+ChunkList sendData(File& file, uint8_t senderID, uint8_t receiverID, size_t mtu = kDefaultMtu);
 
+// Streaming variant for files too large to hold in memory: file only
+// supplies the name and extension, the payload is mapped from source a
+// window at a time as the returned stream is drained.
+ChunkStream sendStream(const File& file, MappedFileSource& source, uint8_t senderID, uint8_t receiverID,
+                       size_t mtu = kDefaultMtu);
 
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+// Destination for reassembled payload bytes, addressed by final file offset.
+struct ChunkSink{
+    virtual ~ChunkSink() = default;
+    virtual bool write(uint64_t offset, std::span<const uint8_t> bytes) = 0;
+};
+
+// Writes into a caller-owned buffer of at least the payload size.
+struct MemorySink : ChunkSink{
+    explicit MemorySink(std::span<uint8_t> dest) : dest(dest){}
+
+    bool write(uint64_t offset, std::span<const uint8_t> bytes) override{
+        if(offset > dest.size() || bytes.size() > dest.size() - offset){
+            return false;
+        }
+        memcpy(dest.data() + offset, bytes.data(), bytes.size());
+        return true;
+    }
+
+    std::span<uint8_t> dest;
+};
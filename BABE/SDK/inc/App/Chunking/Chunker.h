@@ -0,0 +1,39 @@
+#pragma once
+#include "App/Adapters/FileToRaw.h"
+#include "App/Classes/ChunkHeader.h"
+#include "App/Classes/MessageChunksList.h"
+#include "Memory/BufferPool.h"
+#include <cstdint>
+#include <span>
+#include <utility>
+
+// Owner of a chunk list. The descriptor and its header copy share one pool
+// buffer, which goes back to the pool when the handle dies; moving the
+// handle hands the transfer to another layer.
+class ChunkList{
+public:
+    ChunkList() = default;
+    explicit ChunkList(BufferHandle buffer) : buffer_(std::move(buffer)){}
+
+    const MessageChunksList* get() const{ return reinterpret_cast<const MessageChunksList*>(buffer_.data()); }
+    const MessageChunksList* operator->() const{ return get(); }
+    const MessageChunksList& operator*() const{ return *get(); }
+    explicit operator bool() const{ return static_cast<bool>(buffer_); }
+
+    void reset(){ buffer_.reset(); }
+
+private:
+    BufferHandle buffer_;
+};
+
+// Splits a serialized file into chunks of mtu - kChunkHeaderSize bytes.
+// Only the header is copied (into the list's own slab); the payload stays
+// borrowed. Returns an empty list for an invalid view (see RawFileView), or
+// when the transfer needs more than 2^32 chunks or the header more than 255.
+ChunkList chunkFile(const RawFileView& raw, uint32_t transferId, size_t mtu, BufferPool& pool);
+
+Message chunkAt(const MessageChunksList& list, uint32_t seq);
+ChunkHeader chunkHeaderAt(const MessageChunksList& list, uint32_t seq);
+
+// Writes chunks first, first + 1, ... into out; returns how many were written.
+size_t fillChunks(const MessageChunksList& list, uint32_t first, std::span<Message> out);
@@ -0,0 +1,62 @@
+#pragma once
+#include "App/Chunking/ChunkSink.h"
+#include "App/Classes/ChunkHeader.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+enum class ChunkStatus : uint8_t{
+    Accepted,
+    Duplicate,
+    Invalid,   // wrong transfer, out of range, bad length or sink failure
+};
+
+// Bounds on what a received header may ask the Reassembler to allocate.
+// Defaults cover a 4 GiB payload at the default MTU and the largest header
+// chunkFile() emits (u16 name and extension, rounded up to whole chunks).
+struct ReassemblerLimits{
+    uint32_t maxChunks = 1u << 22;
+    uint32_t maxHeaderBytes = 256 * 1024;
+};
+
+// Receiver side of chunkFile(). Chunks may arrive in any order; each data
+// chunk is written once, straight to its final offset in the sink, and a
+// bitmap records which sequence numbers have been seen.
+class Reassembler{
+public:
+    // any comes off the network, so its geometry is checked against limits
+    // before anything is sized from it; see valid().
+    Reassembler(const ChunkHeader& any, ChunkSink& sink, const ReassemblerLimits& limits = {});
+
+    // False when the geometry was inconsistent or over the limits; every
+    // chunk is then rejected as Invalid and the transfer never completes.
+    bool valid() const{ return valid_; }
+
+    ChunkStatus accept(const ChunkHeader& header, std::span<const uint8_t> bytes);
+
+    bool complete() const{ return valid_ && received_ == count_; }
+    uint32_t received() const{ return received_; }
+    uint32_t count() const{ return count_; }
+
+    // First sequence number at or after from that has not arrived, or count().
+    uint32_t nextMissing(uint32_t from = 0) const;
+
+    // Serialized file header; meaningful once all header chunks arrived.
+    std::span<const uint8_t> header() const{ return {header_.data(), headerSize_}; }
+
+    // Exact once the last data chunk arrived, otherwise an upper bound.
+    uint64_t payloadSize() const{ return payloadSize_; }
+
+private:
+    ChunkSink& sink_;
+    uint32_t transferId_;
+    uint32_t count_;
+    uint32_t chunkSize_;
+    uint32_t headerChunks_;
+    uint32_t received_ = 0;
+    uint32_t headerSize_;
+    uint64_t payloadSize_;
+    bool valid_;
+    std::vector<uint64_t> seen_;
+    std::vector<uint8_t> header_;
+};
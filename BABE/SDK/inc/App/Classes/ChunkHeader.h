@@ -0,0 +1,58 @@
+#pragma once
+#include "Helper/WireCodec.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Per-chunk framing sent in front of every chunk's bytes. Any single chunk
+// is enough for a receiver to size its reassembly state.
+struct ChunkHeader{
+    uint32_t transferId;
+    uint32_t seq;
+    uint32_t count;
+    uint16_t chunkSize;
+    uint8_t headerChunks;
+    uint8_t flags;
+};
+
+inline constexpr size_t kChunkHeaderSize = 16;
+
+// UDP payload that fits a 1500-byte Ethernet frame.
+inline constexpr size_t kDefaultMtu = 1472;
+
+// Wire layout of ChunkHeader, big-endian, kChunkHeaderSize bytes.
+struct ChunkHeaderLayout : WireLayout<WireField<uint32_t, 0>, WireField<uint32_t, 4>, WireField<uint32_t, 8>,
+                                      WireField<uint16_t, 12>, WireField<uint8_t, 14>, WireField<uint8_t, 15>>{
+    using TransferId = WireField<uint32_t, 0>;
+    using Seq = WireField<uint32_t, 4>;
+    using Count = WireField<uint32_t, 8>;
+    using ChunkSize = WireField<uint16_t, 12>;
+    using HeaderChunks = WireField<uint8_t, 14>;
+    using Flags = WireField<uint8_t, 15>;
+};
+static_assert(ChunkHeaderLayout::size == kChunkHeaderSize);
+
+constexpr void encodeChunkHeader(const ChunkHeader& header, uint8_t* out){
+    ChunkHeaderLayout::TransferId::set(out, header.transferId);
+    ChunkHeaderLayout::Seq::set(out, header.seq);
+    ChunkHeaderLayout::Count::set(out, header.count);
+    ChunkHeaderLayout::ChunkSize::set(out, header.chunkSize);
+    ChunkHeaderLayout::HeaderChunks::set(out, header.headerChunks);
+    ChunkHeaderLayout::Flags::set(out, header.flags);
+}
+
+// Unchecked: in must hold at least kChunkHeaderSize bytes.
+constexpr ChunkHeader decodeChunkHeader(const uint8_t* in){
+    return ChunkHeader{ChunkHeaderLayout::TransferId::get(in), ChunkHeaderLayout::Seq::get(in),
+                       ChunkHeaderLayout::Count::get(in), ChunkHeaderLayout::ChunkSize::get(in),
+                       ChunkHeaderLayout::HeaderChunks::get(in), ChunkHeaderLayout::Flags::get(in)};
+}
+
+// Validates the frame length once, then decodes without further checks.
+constexpr bool decodeChunkHeader(std::span<const uint8_t> frame, ChunkHeader& header){
+    if(!ChunkHeaderLayout::fits(frame)){
+        return false;
+    }
+    header = decodeChunkHeader(frame.data());
+    return true;
+}
@@ -1,6 +1,8 @@
 #pragma once 
 #include <string>
 #include <cstdint>
+// data holds the whole payload for sendData(); streamed sends (sendStream())
+// leave it null and read the payload from a MappedFileSource instead.
 struct File{
     std::string filename;
     std::string extension;
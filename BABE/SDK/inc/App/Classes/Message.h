@@ -4,7 +4,17 @@
 #include <stddef.h>
 
 struct Message{
-uint16_t SeqNum;
+uint32_t SeqNum;
 size_t size;
 void* data;
-};
\ No newline at end of file
+};
+
+// Serial-number order (RFC 1982) so windows keep working across wrap-around;
+// the Chain ReplayIndex slides its per-flow windows with these.
+inline bool seqBefore(uint32_t a, uint32_t b){
+    return static_cast<int32_t>(a - b) < 0;
+}
+
+inline uint32_t seqDistance(uint32_t from, uint32_t to){
+    return to - from;
+}
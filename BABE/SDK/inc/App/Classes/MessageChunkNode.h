@@ -1,7 +0,0 @@
-#pragma once
-#include "Message.h"
-
-struct MessageChunkNode{
-Message* data;
-MessageChunkNode* next;
-};
\ No newline at end of file
@@ -1,6 +1,17 @@
 #pragma once
-#include "MessageChunkNode.h"
+#include "Message.h"
+#include <cstdint>
+
+// A chunked transfer. Chunks are not stored one by one: the header chunks
+// slice the inline header bytes and the data chunks slice the contiguous
+// payload, so chunk n is found by arithmetic (see chunkAt()).
 struct MessageChunksList{
-    MessageChunkNode* head;
-    MessageChunkNode* tail;
-};
\ No newline at end of file
+    uint32_t transferId;
+    uint32_t count;          // header chunks + data chunks
+    uint32_t chunkSize;      // bytes per chunk, the last of each part may be shorter
+    uint32_t headerChunks;   // chunks [0, headerChunks) carry the file header
+    uint32_t headerSize;
+    uint64_t payloadSize;
+    const uint8_t* header;   // owned, stored right after this struct
+    const uint8_t* payload;  // borrowed from the File
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include "App/Chunking/Chunker.h"
+#include "App/Classes/File.h"
+#include "App/Streaming/MappedFileSource.h"
+#include "Memory/BufferPool.h"
+#include <cstdint>
+#include <span>
+
+// Chunked transfer whose payload is pulled from a MappedFileSource on demand
+// instead of being resident in File::data. Data chunk pointers handed out
+// by next() or at() stay valid until the following call. An invalid stream
+// is empty: list() has no chunks, done() is true, next() returns 0 and at()
+// an empty Message. A source read that fails (source closed, mmap failed)
+// puts the stream in the same state and sets failed().
+class ChunkStream{
+public:
+    ChunkStream(const File& file, MappedFileSource& source, uint32_t transferId, size_t mtu, BufferPool& pool);
+
+    ChunkStream(ChunkStream&& other) noexcept;
+    ChunkStream& operator=(ChunkStream&&) = delete;
+    ChunkStream(const ChunkStream&) = delete;
+    ChunkStream& operator=(const ChunkStream&) = delete;
+
+    // False if the file could not be chunked or its source is unreadable.
+    bool valid() const{ return static_cast<bool>(list_); }
+    const MessageChunksList& list() const;
+    bool done() const{ return !list_ || failed_ || next_ >= list_->count; }
+    bool failed() const{ return failed_; }
+
+    // Next batch in sequence order; returns how many chunks were written.
+    size_t next(std::span<Message> out);
+
+    // Any chunk, e.g. for a retransmit. May move the source window.
+    Message at(uint32_t seq);
+
+private:
+    ChunkList list_;
+    MappedFileSource* source_;
+    uint32_t next_ = 0;
+    bool failed_ = false;
+};
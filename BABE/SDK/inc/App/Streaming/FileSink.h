@@ -0,0 +1,31 @@
+#pragma once
+#include "App/Chunking/ChunkSink.h"
+#include <cstdint>
+#include <vector>
+
+// Streams reassembled payload to disk. Writes that continue the current run
+// are coalesced in a fixed buffer and flushed with one pwrite, so peak
+// memory is the buffer size regardless of the file size.
+class FileSink : public ChunkSink{
+public:
+    explicit FileSink(const char* path, size_t bufferBytes = 1 << 20);
+    ~FileSink() override;
+
+    FileSink(const FileSink&) = delete;
+    FileSink& operator=(const FileSink&) = delete;
+
+    bool isOpen() const{ return fd_ >= 0; }
+
+    bool write(uint64_t offset, std::span<const uint8_t> bytes) override;
+
+    // Flushes the pending run and trims the file to payloadSize.
+    bool finish(uint64_t payloadSize);
+
+private:
+    bool flush();
+
+    int fd_ = -1;
+    std::vector<uint8_t> buffer_;
+    size_t pending_ = 0;
+    uint64_t runOffset_ = 0;
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Read-only view of a file through one sliding mmap window. At most one
+// window is mapped at a time, so resident memory stays bounded by the
+// window size no matter how large the file is; the kernel is asked to read
+// ahead the following window while the current one is consumed.
+class MappedFileSource{
+public:
+    explicit MappedFileSource(const char* path, size_t windowBytes = 64 << 20);
+    ~MappedFileSource();
+
+    MappedFileSource(MappedFileSource&& other) noexcept;
+    MappedFileSource& operator=(MappedFileSource&& other) noexcept;
+    MappedFileSource(const MappedFileSource&) = delete;
+    MappedFileSource& operator=(const MappedFileSource&) = delete;
+
+    bool isOpen() const{ return fd_ >= 0; }
+    uint64_t size() const{ return size_; }
+
+    // Bytes [offset, offset + len). Valid until the next call that has to
+    // move the window; nullptr if the range is outside the file.
+    const uint8_t* map(uint64_t offset, size_t len);
+
+private:
+    void unmap();
+
+    int fd_ = -1;
+    uint64_t size_ = 0;
+    size_t window_ = 0;
+    uint8_t* base_ = nullptr;
+    uint64_t baseOffset_ = 0;
+    size_t mapped_ = 0;
+};
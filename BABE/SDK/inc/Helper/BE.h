@@ -1,9 +0,0 @@
-#pragma once
-#include <arpa/inet.h>
-#include <cstdint>
-
-bool isbigEndian();
-
-void BE16(uint16_t& val);
-void BE32(uint32_t& val);
-void BE64(uint64_t& val);    
\ No newline at end of file
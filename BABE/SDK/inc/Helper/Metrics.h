@@ -0,0 +1,170 @@
+#pragma once
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Hot-path instrumentation: per-thread counters and latency histograms.
+// Recording touches only the calling thread's block (plain stores, no
+// locked instructions); snapshotMetrics() sums every live and exited
+// thread. Build with BABE_METRICS=0 to compile recording out entirely.
+#ifndef BABE_METRICS
+#define BABE_METRICS 1
+#endif
+
+enum class Counter : uint8_t{
+    PoolAllocs,      // buffers served from a slab
+    HeapAllocs,      // buffers that fell back to the heap
+    BytesCopied,     // payload bytes copied in user space
+    ChunksSent,
+    BytesSent,
+    SendCalls,       // sendmmsg syscalls
+    ChunksReceived,
+    BytesReceived,
+    ReceiveCalls,    // recvmmsg syscalls that returned data
+    Count
+};
+
+enum class Stage : uint8_t{
+    Serialize,   // file header encoding
+    Chunk,       // chunk table construction
+    Send,        // one sendmmsg batch
+    Receive,     // one recvmmsg batch
+    Count
+};
+
+inline constexpr size_t kCounterCount = static_cast<size_t>(Counter::Count);
+inline constexpr size_t kStageCount = static_cast<size_t>(Stage::Count);
+
+// Log-linear buckets: 8 per power of two, so any percentile read back is
+// within 12.5% of the true value.
+inline constexpr size_t kHistogramSubBits = 3;
+inline constexpr size_t kHistogramBuckets = (64 - kHistogramSubBits + 1) << kHistogramSubBits;
+
+constexpr size_t histogramBucket(uint64_t value){
+    constexpr uint64_t sub = uint64_t{1} << kHistogramSubBits;
+    if(value < sub){
+        return static_cast<size_t>(value);
+    }
+    size_t exponent = 63 - static_cast<size_t>(std::countl_zero(value));
+    size_t shift = exponent - kHistogramSubBits;
+    return ((shift + 1) << kHistogramSubBits) + static_cast<size_t>((value >> shift) & (sub - 1));
+}
+
+// Largest value that lands in bucket.
+constexpr uint64_t histogramBucketLimit(size_t bucket){
+    constexpr uint64_t sub = uint64_t{1} << kHistogramSubBits;
+    if(bucket < sub){
+        return bucket;
+    }
+    size_t shift = (bucket >> kHistogramSubBits) - 1;
+    uint64_t base = sub + (bucket & (sub - 1));
+    return ((base + 1) << shift) - 1;
+}
+
+struct HistogramSnapshot{
+    uint64_t buckets[kHistogramBuckets] = {};
+    uint64_t count = 0;
+    uint64_t sum = 0;
+
+    void merge(const HistogramSnapshot& other);
+    // Upper bound of the bucket holding quantile q (0..1); 0 when empty.
+    uint64_t percentile(double q) const;
+    double mean() const{ return count ? static_cast<double>(sum) / count : 0.0; }
+};
+
+// Single-writer histogram: one thread records, any thread may snapshot.
+struct LogHistogram{
+    std::atomic<uint64_t> buckets[kHistogramBuckets] = {};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+
+    void record(uint64_t value){
+        bump(buckets[histogramBucket(value)], 1);
+        bump(count, 1);
+        bump(sum, value);
+    }
+    void snapshotInto(HistogramSnapshot& out) const;
+
+private:
+    static void bump(std::atomic<uint64_t>& cell, uint64_t by){
+        cell.store(cell.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+};
+
+struct MetricsSnapshot{
+    uint64_t counters[kCounterCount] = {};
+    HistogramSnapshot stages[kStageCount];
+
+    uint64_t operator[](Counter c) const{ return counters[static_cast<size_t>(c)]; }
+    const HistogramSnapshot& operator[](Stage s) const{ return stages[static_cast<size_t>(s)]; }
+};
+
+MetricsSnapshot snapshotMetrics();
+
+namespace metrics_detail {
+
+struct ThreadMetrics{
+    std::atomic<uint64_t> counters[kCounterCount] = {};
+    LogHistogram stages[kStageCount];
+    ThreadMetrics* next = nullptr;
+    ThreadMetrics* prev = nullptr;
+};
+
+// The calling thread's block, set on its first recording. A constant-
+// initialized pointer needs no TLS init guard, so recording inlines to a
+// TLS load, a test and the store.
+inline thread_local ThreadMetrics* threadBlock = nullptr;
+
+ThreadMetrics& registerThread();
+
+inline ThreadMetrics& local(){
+    ThreadMetrics* block = threadBlock;
+    return block ? *block : registerThread();
+}
+
+}
+
+inline void countMetric(Counter counter, uint64_t by = 1){
+#if BABE_METRICS
+    auto& cell = metrics_detail::local().counters[static_cast<size_t>(counter)];
+    cell.store(cell.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+#else
+    (void)counter;
+    (void)by;
+#endif
+}
+
+inline void recordStage(Stage stage, uint64_t nanos){
+#if BABE_METRICS
+    metrics_detail::local().stages[static_cast<size_t>(stage)].record(nanos);
+#else
+    (void)stage;
+    (void)nanos;
+#endif
+}
+
+// Records the lifetime of the scope into a stage histogram.
+class StageTimer{
+public:
+    explicit StageTimer(Stage stage) : stage_(stage){
+#if BABE_METRICS
+        start_ = std::chrono::steady_clock::now();
+#endif
+    }
+    ~StageTimer(){
+#if BABE_METRICS
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        recordStage(stage_, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+#endif
+    }
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    Stage stage_;
+#if BABE_METRICS
+    std::chrono::steady_clock::time_point start_;
+#endif
+};
@@ -0,0 +1,133 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <utility>
+
+// Network byte order helpers. Byte order is a compile-time constant, so on
+// a big-endian host every conversion below folds away entirely.
+
+template<std::unsigned_integral T>
+constexpr T toBig(T value){
+    if constexpr(std::endian::native == std::endian::big || sizeof(T) == 1){
+        return value;
+    }else{
+        return std::byteswap(value);
+    }
+}
+
+template<std::unsigned_integral T>
+constexpr T fromBig(T value){
+    return toBig(value);
+}
+
+template<std::unsigned_integral T>
+constexpr T loadBE(const uint8_t* src){
+    if consteval{
+        T value = 0;
+        for(size_t i = 0; i < sizeof(T); ++i){
+            value = static_cast<T>((value << 8) | src[i]);
+        }
+        return value;
+    }else{
+        T value;
+        memcpy(&value, src, sizeof(T));
+        return fromBig(value);
+    }
+}
+
+template<std::unsigned_integral T>
+constexpr void storeBE(uint8_t* dst, T value){
+    if consteval{
+        for(size_t i = sizeof(T); i-- > 0;){
+            dst[i] = static_cast<uint8_t>(value);
+            value = static_cast<T>(value >> 8);
+        }
+    }else{
+        value = toBig(value);
+        memcpy(dst, &value, sizeof(T));
+    }
+}
+
+namespace wire_detail {
+
+#if defined(__SSSE3__) || defined(__ARM_NEON)
+// 16-byte lanes reversed per element; lowers to a single pshufb / tbl.
+// __builtin_shufflevector takes constant indices and exists in both Clang
+// and GCC (12+), unlike GCC's __builtin_shuffle.
+typedef uint8_t Lane16 __attribute__((vector_size(16)));
+
+template<size_t Width, size_t... I>
+inline Lane16 swapLane(Lane16 lane, std::index_sequence<I...>){
+    return __builtin_shufflevector(lane, lane, (I / Width * Width + (Width - 1 - I % Width))...);
+}
+#endif
+
+// Byte-swaps count elements of width sizeof(T) from src into dst.
+template<std::unsigned_integral T>
+inline void swapArray(uint8_t* dst, const uint8_t* src, size_t count){
+    size_t i = 0;
+#if defined(__SSSE3__) || defined(__ARM_NEON)
+    constexpr size_t perLane = 16 / sizeof(T);
+    for(; i + perLane <= count; i += perLane){
+        Lane16 lane;
+        memcpy(&lane, src + i * sizeof(T), 16);
+        lane = swapLane<sizeof(T)>(lane, std::make_index_sequence<16>{});
+        memcpy(dst + i * sizeof(T), &lane, 16);
+    }
+#endif
+    for(; i < count; ++i){
+        T value;
+        memcpy(&value, src + i * sizeof(T), sizeof(T));
+        value = std::byteswap(value);
+        memcpy(dst + i * sizeof(T), &value, sizeof(T));
+    }
+}
+
+}
+
+// Bulk conversion of an array of fields. Uses one vector shuffle per 16
+// bytes where the target has a byte shuffle (SSSE3/NEON), bswap otherwise.
+template<std::unsigned_integral T>
+inline void storeBE(uint8_t* dst, std::span<const T> values){
+    if constexpr(std::endian::native == std::endian::big || sizeof(T) == 1){
+        memcpy(dst, values.data(), values.size_bytes());
+    }else{
+        wire_detail::swapArray<T>(dst, reinterpret_cast<const uint8_t*>(values.data()), values.size());
+    }
+}
+
+template<std::unsigned_integral T>
+inline void loadBE(std::span<T> values, const uint8_t* src){
+    if constexpr(std::endian::native == std::endian::big || sizeof(T) == 1){
+        memcpy(values.data(), src, values.size_bytes());
+    }else{
+        wire_detail::swapArray<T>(reinterpret_cast<uint8_t*>(values.data()), src, values.size());
+    }
+}
+
+// A big-endian field at a fixed offset inside a frame. get()/set() do no
+// bounds checking: validate the frame length against the layout once, then
+// access any number of fields.
+template<std::unsigned_integral T, size_t Offset>
+struct WireField{
+    using type = T;
+    static constexpr size_t offset = Offset;
+    static constexpr size_t end = Offset + sizeof(T);
+
+    static constexpr T get(const uint8_t* frame){ return loadBE<T>(frame + Offset); }
+    static constexpr void set(uint8_t* frame, T value){ storeBE<T>(frame + Offset, value); }
+};
+
+// A fixed frame layout built from WireFields; size is the furthest field end.
+template<typename... Fields>
+struct WireLayout{
+    static constexpr size_t size = std::max({size_t{0}, Fields::end...});
+
+    static constexpr bool fits(std::span<const uint8_t> frame){ return frame.size() >= size; }
+};
@@ -0,0 +1,129 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <utility>
+
+// Fixed slab classes served by the pool. Anything larger falls back to the heap.
+inline constexpr size_t kSlabSizes[] = {256, 512, 1024, 4096};
+inline constexpr size_t kSlabClassCount = std::size(kSlabSizes);
+
+// Taken by walking the freelists and thread caches, off the alloc/free path;
+// exact only while the pool is quiescent.
+struct BufferPoolStats{
+    uint64_t hits;       // served from a slab
+    uint64_t misses;     // served from the heap (oversized or class exhausted)
+    uint64_t inUse;      // slabs currently handed out
+    uint64_t cached;     // free slabs parked in thread caches
+    uint64_t highWater;  // slabs ever carved, i.e. peak use per core, summed
+};
+
+class BufferPool;
+
+// Move-only owner of one pool buffer. Passing it by value transfers ownership
+// between layers; the buffer goes back to its pool when the handle dies.
+class BufferHandle{
+public:
+    BufferHandle() = default;
+    BufferHandle(BufferHandle&& other) noexcept
+        : pool_(std::exchange(other.pool_, nullptr)),
+          data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0)){}
+    BufferHandle& operator=(BufferHandle&& other) noexcept{
+        if(this != &other){
+            reset();
+            pool_ = std::exchange(other.pool_, nullptr);
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+    BufferHandle(const BufferHandle&) = delete;
+    BufferHandle& operator=(const BufferHandle&) = delete;
+    ~BufferHandle(){ reset(); }
+
+    uint8_t* data() const{ return data_; }
+    size_t size() const{ return size_; }
+    std::span<uint8_t> view() const{ return {data_, size_}; }
+    explicit operator bool() const{ return data_ != nullptr; }
+
+    // Gives up ownership; hand the pointer back with BufferPool::free().
+    uint8_t* release(){
+        pool_ = nullptr;
+        size_ = 0;
+        return std::exchange(data_, nullptr);
+    }
+
+    void reset();
+
+private:
+    friend class BufferPool;
+    BufferHandle(BufferPool* pool, uint8_t* data, size_t size)
+        : pool_(pool), data_(data), size_(size){}
+
+    BufferPool* pool_ = nullptr;
+    uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Per-core slab allocator. Every core owns a shard holding one lock-free
+// freelist per slab class; a buffer always returns to the shard it came from.
+// Slabs are carved from the shard's arena on first use, so a freelist only
+// ever holds slabs that have been handed out before. In front of the shards,
+// each thread keeps a small cache of free slabs for one pool, so a steady
+// alloc/free cycle touches no shared atomics.
+class BufferPool{
+public:
+    // slabsPerClass is per core and per class; cores == 0 uses every online CPU.
+    explicit BufferPool(uint32_t slabsPerClass = 4096, unsigned cores = 0);
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    BufferHandle alloc(size_t size);
+
+    // Raw interface for structures that embed their own buffer pointer.
+    void* allocRaw(size_t size);
+    void free(void* ptr);
+
+    bool owns(const void* ptr) const;
+
+    BufferPoolStats stats(size_t slabClass) const;
+    BufferPoolStats stats() const;
+
+private:
+    struct Shard;
+    struct ThreadCache;
+
+    static size_t classFor(size_t size);
+    size_t classOf(const void* ptr) const;
+    void* popFrom(Shard& shard, size_t slabClass);
+    void pushFree(void* ptr);
+    ThreadCache* cacheFor();
+
+    uint32_t slabsPerClass_;
+    unsigned shardCount_;
+    unsigned regionShift_;   // log2 of the arena stride per (shard, class)
+    size_t arenaBytes_;
+    uint8_t* arena_;
+    std::unique_ptr<Shard[]> shards_;
+    std::atomic<uint64_t> heapAllocs_[kSlabClassCount + 1] = {};
+    std::atomic<uint64_t> retiredHits_[kSlabClassCount] = {};  // from caches of exited threads
+    uint64_t id_;
+};
+
+// Process-wide pool used by the App layer.
+BufferPool& defaultBufferPool();
+
+inline void BufferHandle::reset(){
+    if(data_){
+        pool_->free(data_);
+        data_ = nullptr;
+        pool_ = nullptr;
+        size_ = 0;
+    }
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include "App/Classes/ChunkHeader.h"
+#include "App/Classes/Message.h"
+#include "App/Classes/MessageChunksList.h"
+#include "Memory/BufferPool.h"
+#include <cstdint>
+#include <memory>
+#include <netinet/in.h>
+#include <span>
+#include <vector>
+#include <sys/socket.h>
+
+enum class TransportMode : uint8_t{
+    Udp,   // datagram socket, works unprivileged and over loopback
+    Raw,   // raw IPv4 socket on kBabeIpProtocol, needs CAP_NET_RAW
+};
+
+// IANA "use for experimentation and testing" protocol number.
+inline constexpr int kBabeIpProtocol = 253;
+
+// Raw IP has no ports, and every kBabeIpProtocol socket on a host sees every
+// datagram (its own sends too, over loopback). Raw mode therefore puts the
+// sender's and receiver's sin_port in front of the ChunkHeader, big-endian,
+// and a receiver keeps only datagrams addressed to its own port; a local
+// port of 0 accepts all of them.
+inline constexpr size_t kRawPortsSize = 4;
+
+struct TransportConfig{
+    TransportMode mode = TransportMode::Udp;
+    uint32_t batchSize = 32;       // datagrams per sendmmsg/recvmmsg call
+    uint32_t inflightBatches = 8;  // batches the socket buffers can hold
+    size_t mtu = kDefaultMtu;
+};
+
+// One received chunk; payload points into one of the transport's receive
+// slots and is valid until the next receiveBatch().
+struct Datagram{
+    ChunkHeader header;
+    std::span<const uint8_t> payload;
+    sockaddr_in from;
+};
+
+// Trans layer backend: moves chunk batches with one sendmmsg/recvmmsg per
+// batch. Each datagram goes out as two iovecs, [encoded ChunkHeader][chunk
+// bytes], so chunk payloads are never copied in user space.
+//
+// Sends share one set of message headers and destination, so calls to
+// sendChunks()/sendRange() must not overlap; the same holds for
+// receiveBatch(). One thread sending while another receives is fine.
+class BatchTransport{
+public:
+    BatchTransport(const TransportConfig& config, const sockaddr_in& local);
+    ~BatchTransport();
+
+    BatchTransport(const BatchTransport&) = delete;
+    BatchTransport& operator=(const BatchTransport&) = delete;
+
+    bool isOpen() const{ return fd_ >= 0; }
+    int fd() const{ return fd_; }
+    const TransportConfig& config() const{ return config_; }
+
+    // Bound address, with the kernel-chosen port when local.sin_port was 0
+    // (in raw mode, the port given at construction).
+    sockaddr_in localAddress() const;
+
+    // Sends the given chunks of list to to. Returns how many were handed to
+    // the kernel; fewer than chunks.size() only on a hard socket error, and
+    // 0 when the transport is not open.
+    size_t sendChunks(const MessageChunksList& list, std::span<const Message> chunks, const sockaddr_in& to);
+
+    // Sends chunks [first, first + count) of list.
+    size_t sendRange(const MessageChunksList& list, uint32_t first, uint32_t count, const sockaddr_in& to);
+
+    // Receives up to out.size() chunks (capped at batchSize), waiting up to
+    // timeoutMs for the first one. Malformed datagrams, and in raw mode those
+    // for another port, are dropped. Returns 0 when the transport is not open.
+    size_t receiveBatch(std::span<Datagram> out, int timeoutMs);
+
+private:
+    bool waitFor(short events, int timeoutMs);
+
+    TransportConfig config_;
+    int fd_ = -1;
+    uint16_t port_;       // raw mode only, network order
+    size_t txFrame_;      // framing bytes in front of each chunk
+    size_t rxSlot_;
+    sockaddr_in peer_{};  // destination of the send in progress
+    std::unique_ptr<mmsghdr[]> txMsgs_;
+    std::unique_ptr<iovec[]> txIov_;
+    std::unique_ptr<uint8_t[]> txHeaders_;
+    std::unique_ptr<mmsghdr[]> rxMsgs_;
+    std::unique_ptr<iovec[]> rxIov_;
+    std::unique_ptr<sockaddr_in[]> rxFrom_;
+    std::vector<BufferHandle> rxSlots_;   // one pool buffer per datagram
+};
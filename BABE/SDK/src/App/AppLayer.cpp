@@ -1,5 +1,36 @@
 #include "App/AppLayer.h"
 #include "App/Adapters/FileToRaw.h"
-MessageChunksList* sendData(File& file, uint8_t senderID, uint8_t receiverID){
-    auto rawFile = toRaw(file);
-}
\ No newline at end of file
+#include "App/Chunking/Chunker.h"
+#include "Helper/Metrics.h"
+#include "Memory/BufferPool.h"
+#include <atomic>
+
+namespace {
+
+std::atomic<uint32_t> nextTransferId{1};
+
+}
+
+ChunkList sendData(File& file, uint8_t senderID, uint8_t receiverID, size_t mtu){
+    (void)senderID;
+    (void)receiverID;
+
+    // Header is rebuilt in place on every send; the payload is never copied.
+    thread_local RawHeaderBuffer headerBuffer;
+    auto rawFile = [&]{
+        StageTimer timer(Stage::Serialize);
+        return toRawView(file, headerBuffer);
+    }();
+
+    StageTimer timer(Stage::Chunk);
+    uint32_t transferId = nextTransferId.fetch_add(1, std::memory_order_relaxed);
+    return chunkFile(rawFile, transferId, mtu, defaultBufferPool());
+}
+
+ChunkStream sendStream(const File& file, MappedFileSource& source, uint8_t senderID, uint8_t receiverID, size_t mtu){
+    (void)senderID;
+    (void)receiverID;
+
+    uint32_t transferId = nextTransferId.fetch_add(1, std::memory_order_relaxed);
+    return ChunkStream(file, source, transferId, mtu, defaultBufferPool());
+}
@@ -0,0 +1,74 @@
+#include "App/Chunking/Chunker.h"
+#include "Helper/Metrics.h"
+#include <algorithm>
+#include <limits>
+#include <new>
+
+namespace {
+
+uint64_t chunksFor(uint64_t bytes, uint64_t chunkSize){
+    return (bytes + chunkSize - 1) / chunkSize;
+}
+
+}
+
+ChunkList chunkFile(const RawFileView& raw, uint32_t transferId, size_t mtu, BufferPool& pool){
+    if(!raw.valid() || mtu <= kChunkHeaderSize || mtu - kChunkHeaderSize > std::numeric_limits<uint16_t>::max()){
+        return {};
+    }
+    uint64_t chunkSize = mtu - kChunkHeaderSize;
+    auto header = raw.header();
+    auto payload = raw.payload();
+
+    uint64_t headerChunks = chunksFor(header.size(), chunkSize);
+    uint64_t count = headerChunks + chunksFor(payload.size(), chunkSize);
+    if(headerChunks > std::numeric_limits<uint8_t>::max() || count > std::numeric_limits<uint32_t>::max()){
+        return {};
+    }
+
+    BufferHandle buffer = pool.alloc(sizeof(MessageChunksList) + header.size());
+    auto list = new (buffer.data()) MessageChunksList{};
+    auto headerCopy = reinterpret_cast<uint8_t*>(list + 1);
+    memcpy(headerCopy, header.data(), header.size());
+    countMetric(Counter::BytesCopied, header.size());
+
+    list->transferId = transferId;
+    list->count = static_cast<uint32_t>(count);
+    list->chunkSize = static_cast<uint32_t>(chunkSize);
+    list->headerChunks = static_cast<uint32_t>(headerChunks);
+    list->headerSize = static_cast<uint32_t>(header.size());
+    list->payloadSize = payload.size();
+    list->header = headerCopy;
+    list->payload = payload.data();
+    return ChunkList(std::move(buffer));
+}
+
+Message chunkAt(const MessageChunksList& list, uint32_t seq){
+    const uint8_t* base = list.header;
+    uint64_t size = list.headerSize;
+    uint64_t index = seq;
+    if(seq >= list.headerChunks){
+        base = list.payload;
+        size = list.payloadSize;
+        index = seq - list.headerChunks;
+    }
+    uint64_t offset = index * list.chunkSize;
+    return Message{seq, static_cast<size_t>(std::min<uint64_t>(list.chunkSize, size - offset)),
+                   const_cast<uint8_t*>(base + offset)};
+}
+
+ChunkHeader chunkHeaderAt(const MessageChunksList& list, uint32_t seq){
+    return ChunkHeader{list.transferId, seq, list.count, static_cast<uint16_t>(list.chunkSize),
+                       static_cast<uint8_t>(list.headerChunks), 0};
+}
+
+size_t fillChunks(const MessageChunksList& list, uint32_t first, std::span<Message> out){
+    if(first >= list.count){
+        return 0;
+    }
+    size_t n = std::min<size_t>(out.size(), list.count - first);
+    for(size_t i = 0; i < n; ++i){
+        out[i] = chunkAt(list, static_cast<uint32_t>(first + i));
+    }
+    return n;
+}
@@ -0,0 +1,77 @@
+#include "App/Chunking/Reassembler.h"
+#include "Helper/Metrics.h"
+#include <bit>
+#include <cstring>
+
+Reassembler::Reassembler(const ChunkHeader& any, ChunkSink& sink, const ReassemblerLimits& limits)
+    : sink_(sink),
+      transferId_(any.transferId),
+      count_(any.count),
+      chunkSize_(any.chunkSize),
+      headerChunks_(any.headerChunks),
+      headerSize_(0),
+      payloadSize_(0),
+      valid_(any.count != 0 && any.chunkSize != 0 && any.headerChunks <= any.count
+             && any.count <= limits.maxChunks
+             && static_cast<uint64_t>(any.headerChunks) * any.chunkSize <= limits.maxHeaderBytes){
+    if(!valid_){
+        return;
+    }
+    headerSize_ = headerChunks_ * chunkSize_;
+    payloadSize_ = static_cast<uint64_t>(count_ - headerChunks_) * chunkSize_;
+    seen_.assign((static_cast<uint64_t>(count_) + 63) / 64, 0);
+    header_.resize(headerSize_);
+}
+
+ChunkStatus Reassembler::accept(const ChunkHeader& header, std::span<const uint8_t> bytes){
+    if(!valid_ || header.transferId != transferId_ || header.count != count_ || header.chunkSize != chunkSize_
+       || header.headerChunks != headerChunks_ || header.seq >= count_
+       || bytes.empty() || bytes.size() > chunkSize_){
+        return ChunkStatus::Invalid;
+    }
+
+    uint32_t seq = header.seq;
+    bool lastOfPart = seq + 1 == headerChunks_ || seq + 1 == count_;
+    if(!lastOfPart && bytes.size() != chunkSize_){
+        return ChunkStatus::Invalid;
+    }
+    uint64_t& word = seen_[seq / 64];
+    uint64_t bit = uint64_t{1} << (seq % 64);
+    if(word & bit){
+        return ChunkStatus::Duplicate;
+    }
+
+    if(seq < headerChunks_){
+        memcpy(header_.data() + static_cast<size_t>(seq) * chunkSize_, bytes.data(), bytes.size());
+        if(seq + 1 == headerChunks_){
+            headerSize_ = seq * chunkSize_ + static_cast<uint32_t>(bytes.size());
+        }
+    }else{
+        uint64_t offset = static_cast<uint64_t>(seq - headerChunks_) * chunkSize_;
+        if(!sink_.write(offset, bytes)){
+            return ChunkStatus::Invalid;
+        }
+        if(seq + 1 == count_){
+            payloadSize_ = offset + bytes.size();
+        }
+    }
+
+    word |= bit;
+    ++received_;
+    countMetric(Counter::BytesCopied, bytes.size());
+    return ChunkStatus::Accepted;
+}
+
+uint32_t Reassembler::nextMissing(uint32_t from) const{
+    for(uint64_t w = from / 64; w < seen_.size(); ++w){
+        uint64_t missing = ~seen_[w];
+        if(w == from / 64){
+            missing &= ~uint64_t{0} << (from % 64);
+        }
+        if(missing){
+            uint64_t seq = w * 64 + std::countr_zero(missing);
+            return seq < count_ ? static_cast<uint32_t>(seq) : count_;
+        }
+    }
+    return count_;
+}
@@ -0,0 +1,81 @@
+#include "App/Streaming/ChunkStream.h"
+#include "App/Adapters/FileToRaw.h"
+#include "App/Chunking/Chunker.h"
+#include <algorithm>
+#include <utility>
+
+ChunkStream::ChunkStream(const File& file, MappedFileSource& source, uint32_t transferId, size_t mtu, BufferPool& pool)
+    : source_(&source){
+    if(!source.isOpen()){
+        return;
+    }
+    // Only the metadata of file is used: the payload comes from source.
+    File meta{file.filename, file.extension, static_cast<size_t>(source.size()), nullptr};
+    RawHeaderBuffer header;
+    list_ = chunkFile(toRawView(meta, header), transferId, mtu, pool);
+}
+
+ChunkStream::ChunkStream(ChunkStream&& other) noexcept
+    : list_(std::move(other.list_)),
+      source_(other.source_),
+      next_(other.next_),
+      failed_(other.failed_){}
+
+const MessageChunksList& ChunkStream::list() const{
+    static constexpr MessageChunksList kEmpty{};
+    return list_ ? *list_ : kEmpty;
+}
+
+Message ChunkStream::at(uint32_t seq){
+    if(!list_ || failed_ || seq >= list_->count){
+        return Message{seq, 0, nullptr};
+    }
+    Message chunk = chunkAt(*list_, seq);
+    if(seq >= list_->headerChunks){
+        uint64_t offset = static_cast<uint64_t>(seq - list_->headerChunks) * list_->chunkSize;
+        const uint8_t* data = source_->map(offset, chunk.size);
+        if(!data){
+            failed_ = true;
+            return Message{seq, 0, nullptr};
+        }
+        chunk.data = const_cast<uint8_t*>(data);
+    }
+    return chunk;
+}
+
+size_t ChunkStream::next(std::span<Message> out){
+    if(done()){
+        return 0;
+    }
+    size_t n = std::min<size_t>(out.size(), list_->count - next_);
+    if(n == 0){
+        return 0;
+    }
+    // Map the whole batch up front so one window covers every chunk in it.
+    uint32_t last = next_ + static_cast<uint32_t>(n) - 1;
+    if(last >= list_->headerChunks){
+        uint32_t firstData = std::max(next_, list_->headerChunks);
+        uint64_t begin = static_cast<uint64_t>(firstData - list_->headerChunks) * list_->chunkSize;
+        uint64_t end = std::min<uint64_t>(list_->payloadSize,
+                                          static_cast<uint64_t>(last - list_->headerChunks + 1) * list_->chunkSize);
+        const uint8_t* base = source_->map(begin, end - begin);
+        if(!base){
+            // Handing out null data with a non-zero size would fault in the
+            // transport; stop here and leave next_ on the unsent batch.
+            failed_ = true;
+            return 0;
+        }
+        for(size_t i = 0; i < n; ++i){
+            Message chunk = chunkAt(*list_, next_ + static_cast<uint32_t>(i));
+            if(chunk.SeqNum >= list_->headerChunks){
+                uint64_t offset = static_cast<uint64_t>(chunk.SeqNum - list_->headerChunks) * list_->chunkSize;
+                chunk.data = const_cast<uint8_t*>(base + (offset - begin));
+            }
+            out[i] = chunk;
+        }
+    }else{
+        fillChunks(*list_, next_, out.first(n));
+    }
+    next_ += static_cast<uint32_t>(n);
+    return n;
+}
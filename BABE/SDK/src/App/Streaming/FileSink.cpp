@@ -0,0 +1,66 @@
+#include "App/Streaming/FileSink.h"
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+// pwrite may write less than asked (signals, quotas); loop until it all lands.
+bool writeAll(int fd, const uint8_t* data, size_t size, uint64_t offset){
+    size_t done = 0;
+    while(done < size){
+        ssize_t n = pwrite(fd, data + done, size - done, static_cast<off_t>(offset + done));
+        if(n <= 0){
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+}
+
+FileSink::FileSink(const char* path, size_t bufferBytes)
+    : buffer_(bufferBytes){
+    fd_ = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+}
+
+FileSink::~FileSink(){
+    if(fd_ >= 0){
+        flush();
+        close(fd_);
+    }
+}
+
+bool FileSink::flush(){
+    if(!writeAll(fd_, buffer_.data(), pending_, runOffset_)){
+        return false;
+    }
+    runOffset_ += pending_;
+    pending_ = 0;
+    return true;
+}
+
+bool FileSink::write(uint64_t offset, std::span<const uint8_t> bytes){
+    if(fd_ < 0){
+        return false;
+    }
+    bool continuesRun = offset == runOffset_ + pending_;
+    if(!continuesRun || bytes.size() > buffer_.size() - pending_){
+        if(!flush()){
+            return false;
+        }
+        runOffset_ = offset;
+    }
+    if(bytes.size() > buffer_.size()){
+        runOffset_ = offset + bytes.size();
+        return writeAll(fd_, bytes.data(), bytes.size(), offset);
+    }
+    memcpy(buffer_.data() + pending_, bytes.data(), bytes.size());
+    pending_ += bytes.size();
+    return true;
+}
+
+bool FileSink::finish(uint64_t payloadSize){
+    return fd_ >= 0 && flush() && ftruncate(fd_, static_cast<off_t>(payloadSize)) == 0;
+}
@@ -0,0 +1,94 @@
+#include "App/Streaming/MappedFileSource.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+MappedFileSource::MappedFileSource(const char* path, size_t windowBytes){
+    long page = sysconf(_SC_PAGESIZE);
+    window_ = std::max<size_t>(page, windowBytes / page * page);
+
+    fd_ = open(path, O_RDONLY | O_CLOEXEC);
+    if(fd_ < 0){
+        return;
+    }
+    struct stat st;
+    if(fstat(fd_, &st) != 0){
+        close(fd_);
+        fd_ = -1;
+        return;
+    }
+    size_ = static_cast<uint64_t>(st.st_size);
+    posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+}
+
+MappedFileSource::~MappedFileSource(){
+    unmap();
+    if(fd_ >= 0){
+        close(fd_);
+    }
+}
+
+MappedFileSource::MappedFileSource(MappedFileSource&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1)),
+      size_(std::exchange(other.size_, 0)),
+      window_(other.window_),
+      base_(std::exchange(other.base_, nullptr)),
+      baseOffset_(std::exchange(other.baseOffset_, 0)),
+      mapped_(std::exchange(other.mapped_, 0)){}
+
+MappedFileSource& MappedFileSource::operator=(MappedFileSource&& other) noexcept{
+    if(this != &other){
+        unmap();
+        if(fd_ >= 0){
+            close(fd_);
+        }
+        fd_ = std::exchange(other.fd_, -1);
+        size_ = std::exchange(other.size_, 0);
+        window_ = other.window_;
+        base_ = std::exchange(other.base_, nullptr);
+        baseOffset_ = std::exchange(other.baseOffset_, 0);
+        mapped_ = std::exchange(other.mapped_, 0);
+    }
+    return *this;
+}
+
+void MappedFileSource::unmap(){
+    if(base_){
+        munmap(base_, mapped_);
+        base_ = nullptr;
+        mapped_ = 0;
+    }
+}
+
+const uint8_t* MappedFileSource::map(uint64_t offset, size_t len){
+    if(fd_ < 0 || offset > size_ || len > size_ - offset){
+        return nullptr;
+    }
+    if(base_ && offset >= baseOffset_ && offset + len <= baseOffset_ + mapped_){
+        return base_ + (offset - baseOffset_);
+    }
+
+    unmap();
+    uint64_t start = offset - offset % window_;
+    // A range straddling two windows gets a mapping one window larger.
+    uint64_t end = std::min<uint64_t>(size_, std::max(start + window_, offset + len));
+    if(end == start){
+        return nullptr;
+    }
+    void* base = mmap(nullptr, end - start, PROT_READ, MAP_SHARED, fd_, static_cast<off_t>(start));
+    if(base == MAP_FAILED){
+        return nullptr;
+    }
+    base_ = static_cast<uint8_t*>(base);
+    baseOffset_ = start;
+    mapped_ = end - start;
+
+    madvise(base_, mapped_, MADV_SEQUENTIAL);
+    if(end < size_){
+        posix_fadvise(fd_, static_cast<off_t>(end), static_cast<off_t>(window_), POSIX_FADV_WILLNEED);
+    }
+    return base_ + (offset - baseOffset_);
+}
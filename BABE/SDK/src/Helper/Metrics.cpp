@@ -0,0 +1,99 @@
+#include "Helper/Metrics.h"
+#include <mutex>
+
+namespace {
+
+// Threads register once; the mutex is never taken on the recording path.
+std::mutex registryMutex;
+metrics_detail::ThreadMetrics* registryHead = nullptr;
+MetricsSnapshot retired;
+
+// Where recordings made after a thread's block is gone (from other
+// thread_local destructors) end up; never read.
+metrics_detail::ThreadMetrics orphan;
+
+void addThread(const metrics_detail::ThreadMetrics& block, MetricsSnapshot& out){
+    for(size_t c = 0; c < kCounterCount; ++c){
+        out.counters[c] += block.counters[c].load(std::memory_order_relaxed);
+    }
+    HistogramSnapshot stage;
+    for(size_t s = 0; s < kStageCount; ++s){
+        block.stages[s].snapshotInto(stage);
+        out.stages[s].merge(stage);
+    }
+}
+
+struct Registration{
+    metrics_detail::ThreadMetrics block;
+
+    Registration(){
+        std::lock_guard lock(registryMutex);
+        block.next = registryHead;
+        if(registryHead){
+            registryHead->prev = &block;
+        }
+        registryHead = &block;
+    }
+
+    ~Registration(){
+        metrics_detail::threadBlock = &orphan;
+        std::lock_guard lock(registryMutex);
+        addThread(block, retired);
+        if(block.prev){
+            block.prev->next = block.next;
+        }else{
+            registryHead = block.next;
+        }
+        if(block.next){
+            block.next->prev = block.prev;
+        }
+    }
+};
+
+}
+
+void HistogramSnapshot::merge(const HistogramSnapshot& other){
+    for(size_t b = 0; b < kHistogramBuckets; ++b){
+        buckets[b] += other.buckets[b];
+    }
+    count += other.count;
+    sum += other.sum;
+}
+
+uint64_t HistogramSnapshot::percentile(double q) const{
+    if(count == 0){
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count - 1)) + 1;
+    uint64_t seen = 0;
+    for(size_t b = 0; b < kHistogramBuckets; ++b){
+        seen += buckets[b];
+        if(seen >= rank){
+            return histogramBucketLimit(b);
+        }
+    }
+    return histogramBucketLimit(kHistogramBuckets - 1);
+}
+
+void LogHistogram::snapshotInto(HistogramSnapshot& out) const{
+    for(size_t b = 0; b < kHistogramBuckets; ++b){
+        out.buckets[b] = buckets[b].load(std::memory_order_relaxed);
+    }
+    out.count = count.load(std::memory_order_relaxed);
+    out.sum = sum.load(std::memory_order_relaxed);
+}
+
+metrics_detail::ThreadMetrics& metrics_detail::registerThread(){
+    thread_local Registration registration;
+    threadBlock = &registration.block;
+    return registration.block;
+}
+
+MetricsSnapshot snapshotMetrics(){
+    std::lock_guard lock(registryMutex);
+    MetricsSnapshot out = retired;
+    for(auto block = registryHead; block; block = block->next){
+        addThread(*block, out);
+    }
+    return out;
+}
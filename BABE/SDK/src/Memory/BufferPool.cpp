@@ -0,0 +1,334 @@
+#include "Memory/BufferPool.h"
+#include "Helper/Metrics.h"
+#include <algorithm>
+#include <bit>
+#include <mutex>
+#include <new>
+#include <sched.h>
+#include <sys/mman.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct alignas(64) SlabFreelist{
+    std::atomic<uint64_t> head{0};      // (tag << 32) | (index + 1); 0 when empty
+    std::atomic<uint32_t> carved{0};    // slabs [0, carved) have been handed out
+    std::atomic<uint64_t> hits{0};      // pops and carves, on the line the pop already owns
+    std::atomic<uint32_t>* links = nullptr;  // links[i] = next index + 1
+    uint8_t* base = nullptr;
+};
+
+constexpr uint64_t packHead(uint64_t tag, uint32_t link){
+    return (tag << 32) | link;
+}
+
+constexpr uint32_t kCacheSlots = 32;
+
+// Pools alive right now. Ids are never reused, so a thread cache can tell
+// whether the pool it is bound to still exists; poolDeaths lets it skip the
+// lock until some pool has actually gone away.
+std::mutex livePoolsMutex;
+std::vector<uint64_t> livePools;
+std::atomic<uint64_t> nextPoolId{1};
+std::atomic<uint64_t> poolDeaths{0};
+
+// What a thread cache publishes for BufferPool::stats(). Only the owning
+// thread writes the counters, so a relaxed load and store stand in for an
+// increment; poolId changes only under livePoolsMutex.
+struct CacheTally{
+    uint64_t poolId = 0;
+    std::atomic<uint64_t> hits[kSlabClassCount] = {};
+    std::atomic<uint32_t> count[kSlabClassCount] = {};
+};
+std::vector<CacheTally*> threadCaches;  // guarded by livePoolsMutex
+
+void bump(std::atomic<uint64_t>& counter){
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+bool isLive(uint64_t id){
+    return std::find(livePools.begin(), livePools.end(), id) != livePools.end();
+}
+
+static_assert(std::ranges::all_of(kSlabSizes, [](size_t size){ return std::has_single_bit(size); }),
+              "free() finds a slab by shifting");
+
+// sched_getcpu() costs as much as the pop itself, and a stale answer only
+// costs locality, so it is refreshed every 64 allocations per thread.
+unsigned currentCpu(){
+    thread_local unsigned cpu = 0;
+    thread_local uint32_t calls = 0;
+    if((calls++ & 63) == 0){
+        int c = sched_getcpu();
+        cpu = c < 0 ? 0 : static_cast<unsigned>(c);
+    }
+    return cpu;
+}
+
+}
+
+struct BufferPool::Shard{
+    SlabFreelist lists[kSlabClassCount];
+    std::unique_ptr<std::atomic<uint32_t>[]> links;
+};
+
+struct BufferPool::ThreadCache : CacheTally{
+    BufferPool* pool = nullptr;
+    uint64_t deathsSeen = 0;
+    void* slabs[kSlabClassCount][kCacheSlots];
+
+    // Hands the cached slabs and the hit count back when the thread exits,
+    // unless the pool went first (its arena, and so the slabs, are gone with it).
+    ~ThreadCache(){
+        std::lock_guard<std::mutex> lock(livePoolsMutex);
+        if(poolId != 0){
+            threadCaches.erase(std::find(threadCaches.begin(), threadCaches.end(), this));
+        }
+        if(pool && isLive(poolId)){
+            for(size_t c = 0; c < kSlabClassCount; ++c){
+                uint32_t n = count[c].load(std::memory_order_relaxed);
+                for(uint32_t i = 0; i < n; ++i){
+                    pool->pushFree(slabs[c][i]);
+                }
+                pool->retiredHits_[c].fetch_add(hits[c].load(std::memory_order_relaxed),
+                                                std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+BufferPool::BufferPool(uint32_t slabsPerClass, unsigned cores)
+    : slabsPerClass_(slabsPerClass),
+      shardCount_(cores ? cores : std::max(1u, std::thread::hardware_concurrency())),
+      arena_(nullptr),
+      id_(nextPoolId.fetch_add(1, std::memory_order_relaxed)){
+    // Every (shard, class) region gets the same power-of-two stride, sized
+    // for the largest class, so free() locates a slab with shifts alone.
+    // Untouched slabs never become resident, so the slack is only address space.
+    regionShift_ = static_cast<unsigned>(std::countr_zero(std::bit_ceil(std::max(slabsPerClass_, 1u))
+                                                          * kSlabSizes[kSlabClassCount - 1]));
+    arenaBytes_ = (size_t{shardCount_} * kSlabClassCount) << regionShift_;
+    void* arena = mmap(nullptr, arenaBytes_, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if(arena == MAP_FAILED){
+        throw std::bad_alloc();
+    }
+    arena_ = static_cast<uint8_t*>(arena);
+
+    shards_ = std::make_unique<Shard[]>(shardCount_);
+    for(unsigned s = 0; s < shardCount_; ++s){
+        Shard& shard = shards_[s];
+        shard.links = std::make_unique<std::atomic<uint32_t>[]>(kSlabClassCount * slabsPerClass_);
+        for(size_t c = 0; c < kSlabClassCount; ++c){
+            SlabFreelist& list = shard.lists[c];
+            list.base = arena_ + ((s * kSlabClassCount + c) << regionShift_);
+            list.links = shard.links.get() + c * slabsPerClass_;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(livePoolsMutex);
+    livePools.push_back(id_);
+}
+
+BufferPool::~BufferPool(){
+    {
+        std::lock_guard<std::mutex> lock(livePoolsMutex);
+        livePools.erase(std::find(livePools.begin(), livePools.end(), id_));
+        poolDeaths.fetch_add(1, std::memory_order_release);
+    }
+    munmap(arena_, arenaBytes_);
+}
+
+BufferPool::ThreadCache* BufferPool::cacheFor(){
+    thread_local ThreadCache cache;
+    if(cache.poolId == id_){
+        return &cache;
+    }
+    // A thread caches for one pool at a time: the first it meets, or the
+    // next one once that pool is destroyed. Others use the shards directly.
+    uint64_t deaths = poolDeaths.load(std::memory_order_acquire);
+    if(cache.poolId != 0 && cache.deathsSeen == deaths){
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(livePoolsMutex);
+    cache.deathsSeen = deaths;
+    if(cache.poolId != 0 && isLive(cache.poolId)){
+        return nullptr;
+    }
+    if(cache.poolId == 0){
+        threadCaches.push_back(&cache);
+    }
+    cache.pool = this;
+    cache.poolId = id_;
+    for(size_t c = 0; c < kSlabClassCount; ++c){
+        cache.hits[c].store(0, std::memory_order_relaxed);
+        cache.count[c].store(0, std::memory_order_relaxed);
+    }
+    return &cache;
+}
+
+size_t BufferPool::classFor(size_t size){
+    for(size_t c = 0; c < kSlabClassCount; ++c){
+        if(size <= kSlabSizes[c]){
+            return c;
+        }
+    }
+    return kSlabClassCount;
+}
+
+void* BufferPool::popFrom(Shard& shard, size_t slabClass){
+    SlabFreelist& list = shard.lists[slabClass];
+    uint64_t head = list.head.load(std::memory_order_acquire);
+    for(;;){
+        uint32_t link = static_cast<uint32_t>(head);
+        if(link == 0){
+            break;
+        }
+        uint32_t next = list.links[link - 1].load(std::memory_order_relaxed);
+        if(list.head.compare_exchange_weak(head, packHead((head >> 32) + 1, next),
+                                           std::memory_order_acq_rel, std::memory_order_acquire)){
+            list.hits.fetch_add(1, std::memory_order_relaxed);
+            return list.base + static_cast<size_t>(link - 1) * kSlabSizes[slabClass];
+        }
+    }
+
+    // Freelist empty: carve a fresh slab. The load keeps the counter from
+    // creeping past the class once it is exhausted.
+    if(list.carved.load(std::memory_order_relaxed) >= slabsPerClass_){
+        return nullptr;
+    }
+    uint32_t index = list.carved.fetch_add(1, std::memory_order_relaxed);
+    if(index >= slabsPerClass_){
+        return nullptr;
+    }
+    list.hits.fetch_add(1, std::memory_order_relaxed);
+    return list.base + static_cast<size_t>(index) * kSlabSizes[slabClass];
+}
+
+void* BufferPool::allocRaw(size_t size){
+    size_t slabClass = classFor(size);
+    if(slabClass < kSlabClassCount){
+        ThreadCache* cache = cacheFor();
+        if(uint32_t count = cache ? cache->count[slabClass].load(std::memory_order_relaxed) : 0){
+            cache->count[slabClass].store(count - 1, std::memory_order_relaxed);
+            bump(cache->hits[slabClass]);
+            countMetric(Counter::PoolAllocs);
+            return cache->slabs[slabClass][count - 1];
+        }
+        unsigned home = currentCpu() % shardCount_;
+        for(unsigned i = 0; i < shardCount_; ++i){
+            if(void* ptr = popFrom(shards_[(home + i) % shardCount_], slabClass)){
+                countMetric(Counter::PoolAllocs);
+                return ptr;
+            }
+        }
+    }
+    heapAllocs_[slabClass].fetch_add(1, std::memory_order_relaxed);
+    countMetric(Counter::HeapAllocs);
+    return ::operator new(size ? size : 1);
+}
+
+BufferHandle BufferPool::alloc(size_t size){
+    return BufferHandle(this, static_cast<uint8_t*>(allocRaw(size)), size);
+}
+
+bool BufferPool::owns(const void* ptr) const{
+    auto p = static_cast<const uint8_t*>(ptr);
+    return p >= arena_ && p < arena_ + arenaBytes_;
+}
+
+void BufferPool::free(void* ptr){
+    if(!ptr){
+        return;
+    }
+    if(!owns(ptr)){
+        ::operator delete(ptr);
+        return;
+    }
+    if(ThreadCache* cache = cacheFor()){
+        size_t slabClass = classOf(ptr);
+        uint32_t count = cache->count[slabClass].load(std::memory_order_relaxed);
+        if(count == kCacheSlots){
+            // Spill half so the next few frees and allocs both stay local.
+            for(uint32_t i = kCacheSlots / 2; i < kCacheSlots; ++i){
+                pushFree(cache->slabs[slabClass][i]);
+            }
+            count = kCacheSlots / 2;
+        }
+        cache->slabs[slabClass][count] = ptr;
+        cache->count[slabClass].store(count + 1, std::memory_order_relaxed);
+        return;
+    }
+    pushFree(ptr);
+}
+
+size_t BufferPool::classOf(const void* ptr) const{
+    return (static_cast<size_t>(static_cast<const uint8_t*>(ptr) - arena_) >> regionShift_) % kSlabClassCount;
+}
+
+void BufferPool::pushFree(void* ptr){
+    size_t offset = static_cast<uint8_t*>(ptr) - arena_;
+    size_t region = offset >> regionShift_;
+    size_t slabClass = region % kSlabClassCount;
+    SlabFreelist& list = shards_[region / kSlabClassCount].lists[slabClass];
+    offset &= (size_t{1} << regionShift_) - 1;
+    uint32_t link = static_cast<uint32_t>(offset >> std::countr_zero(kSlabSizes[slabClass])) + 1;
+    uint64_t head = list.head.load(std::memory_order_relaxed);
+    do{
+        list.links[link - 1].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+    }while(!list.head.compare_exchange_weak(head, packHead((head >> 32) + 1, link),
+                                            std::memory_order_release, std::memory_order_relaxed));
+}
+
+BufferPoolStats BufferPool::stats(size_t slabClass) const{
+    BufferPoolStats out{0, heapAllocs_[slabClass].load(std::memory_order_relaxed), 0, 0, 0};
+    if(slabClass >= kSlabClassCount){
+        return out;
+    }
+    out.hits = retiredHits_[slabClass].load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(livePoolsMutex);
+        for(const CacheTally* cache : threadCaches){
+            if(cache->poolId == id_){
+                out.hits += cache->hits[slabClass].load(std::memory_order_relaxed);
+                out.cached += cache->count[slabClass].load(std::memory_order_relaxed);
+            }
+        }
+    }
+    uint64_t outside = 0;   // carved slabs on no freelist
+    for(unsigned s = 0; s < shardCount_; ++s){
+        const SlabFreelist& list = shards_[s].lists[slabClass];
+        uint32_t carved = std::min(list.carved.load(std::memory_order_relaxed), slabsPerClass_);
+        // Bounded by carved so a concurrent push/pop cannot keep the walk going.
+        uint32_t free = 0;
+        for(uint32_t link = static_cast<uint32_t>(list.head.load(std::memory_order_acquire));
+            link && free < carved; ++free){
+            link = list.links[link - 1].load(std::memory_order_relaxed);
+        }
+        out.hits += list.hits.load(std::memory_order_relaxed);
+        outside += carved - free;
+        out.highWater += carved;
+    }
+    // A slab moving between a cache and a freelist mid-walk can be seen twice.
+    out.inUse = outside > out.cached ? outside - out.cached : 0;
+    return out;
+}
+
+BufferPoolStats BufferPool::stats() const{
+    BufferPoolStats total = stats(kSlabClassCount);
+    for(size_t c = 0; c < kSlabClassCount; ++c){
+        BufferPoolStats s = stats(c);
+        total.hits += s.hits;
+        total.misses += s.misses;
+        total.inUse += s.inUse;
+        total.cached += s.cached;
+        total.highWater += s.highWater;
+    }
+    return total;
+}
+
+BufferPool& defaultBufferPool(){
+    static BufferPool pool;
+    return pool;
+}
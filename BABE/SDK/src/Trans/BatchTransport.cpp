@@ -0,0 +1,232 @@
+#include "Trans/BatchTransport.h"
+#include "App/Chunking/Chunker.h"
+#include "Helper/Metrics.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <poll.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+// Room for an IPv4 header with options, which raw sockets deliver inline.
+constexpr size_t kMaxIpHeader = 60;
+
+// Sleep between sendmmsg retries on ENOBUFS, doubled while it persists.
+constexpr std::chrono::microseconds kMinBackoff{20};
+constexpr std::chrono::microseconds kMaxBackoff{2000};
+
+void setBuffer(int fd, int option, int forceOption, int bytes){
+    // The *FORCE variants ignore rmem_max/wmem_max but need CAP_NET_ADMIN.
+    if(setsockopt(fd, SOL_SOCKET, forceOption, &bytes, sizeof(bytes)) != 0){
+        setsockopt(fd, SOL_SOCKET, option, &bytes, sizeof(bytes));
+    }
+}
+
+}
+
+BatchTransport::BatchTransport(const TransportConfig& config, const sockaddr_in& local)
+    : config_(config),
+      port_(local.sin_port),
+      txFrame_(kChunkHeaderSize + (config.mode == TransportMode::Raw ? kRawPortsSize : 0)),
+      rxSlot_(config.mtu + kRawPortsSize + kMaxIpHeader){
+    config_.batchSize = std::max(1u, config_.batchSize);
+    config_.inflightBatches = std::max(1u, config_.inflightBatches);
+
+    bool raw = config_.mode == TransportMode::Raw;
+    fd_ = socket(AF_INET, (raw ? SOCK_RAW : SOCK_DGRAM) | SOCK_NONBLOCK | SOCK_CLOEXEC, raw ? kBabeIpProtocol : 0);
+    if(fd_ < 0){
+        return;
+    }
+    int bytes = static_cast<int>(std::min<size_t>(1u << 30,
+                                                  size_t{config_.inflightBatches} * config_.batchSize * rxSlot_));
+    setBuffer(fd_, SO_SNDBUF, SO_SNDBUFFORCE, bytes);
+    setBuffer(fd_, SO_RCVBUF, SO_RCVBUFFORCE, bytes);
+    if(bind(fd_, reinterpret_cast<const sockaddr*>(&local), sizeof(local)) != 0){
+        close(fd_);
+        fd_ = -1;
+        return;
+    }
+
+    size_t batch = config_.batchSize;
+    txMsgs_ = std::make_unique<mmsghdr[]>(batch);
+    txIov_ = std::make_unique<iovec[]>(batch * 2);
+    txHeaders_ = std::make_unique<uint8_t[]>(batch * txFrame_);
+    rxMsgs_ = std::make_unique<mmsghdr[]>(batch);
+    rxIov_ = std::make_unique<iovec[]>(batch);
+    rxFrom_ = std::make_unique<sockaddr_in[]>(batch);
+    rxSlots_.reserve(batch);
+
+    for(size_t i = 0; i < batch; ++i){
+        msghdr& tx = txMsgs_[i].msg_hdr;
+        tx = {};
+        tx.msg_name = &peer_;
+        tx.msg_namelen = sizeof(peer_);
+        tx.msg_iov = &txIov_[i * 2];
+        tx.msg_iovlen = 2;
+        txIov_[i * 2].iov_base = &txHeaders_[i * txFrame_];
+        txIov_[i * 2].iov_len = txFrame_;
+
+        rxSlots_.push_back(defaultBufferPool().alloc(rxSlot_));
+        rxIov_[i] = {rxSlots_[i].data(), rxSlot_};
+        msghdr& rx = rxMsgs_[i].msg_hdr;
+        rx = {};
+        rx.msg_iov = &rxIov_[i];
+        rx.msg_iovlen = 1;
+        rx.msg_name = &rxFrom_[i];
+    }
+}
+
+BatchTransport::~BatchTransport(){
+    if(fd_ >= 0){
+        close(fd_);
+    }
+}
+
+sockaddr_in BatchTransport::localAddress() const{
+    sockaddr_in addr{};
+    socklen_t len = sizeof(addr);
+    if(fd_ >= 0 && getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &len) == 0
+       && config_.mode == TransportMode::Raw){
+        addr.sin_port = port_;
+    }
+    return addr;
+}
+
+bool BatchTransport::waitFor(short events, int timeoutMs){
+    pollfd pfd{fd_, events, 0};
+    return poll(&pfd, 1, timeoutMs) > 0;
+}
+
+size_t BatchTransport::sendChunks(const MessageChunksList& list, std::span<const Message> chunks, const sockaddr_in& to){
+    if(!isOpen()){
+        return 0;
+    }
+    peer_ = to;
+    bool raw = config_.mode == TransportMode::Raw;
+    size_t sent = 0;
+    while(sent < chunks.size()){
+        StageTimer timer(Stage::Send);
+        size_t n = std::min<size_t>(config_.batchSize, chunks.size() - sent);
+        size_t bytes = 0;
+        for(size_t i = 0; i < n; ++i){
+            const Message& chunk = chunks[sent + i];
+            uint8_t* frame = &txHeaders_[i * txFrame_];
+            if(raw){
+                // sin_port is already in network order.
+                memcpy(frame, &port_, 2);
+                memcpy(frame + 2, &to.sin_port, 2);
+                frame += kRawPortsSize;
+            }
+            encodeChunkHeader(chunkHeaderAt(list, chunk.SeqNum), frame);
+            txIov_[i * 2 + 1] = {chunk.data, chunk.size};
+            bytes += chunk.size;
+        }
+
+        size_t done = 0;
+        auto backoff = kMinBackoff;
+        while(done < n){
+            int r = sendmmsg(fd_, &txMsgs_[done], static_cast<unsigned>(n - done), 0);
+            countMetric(Counter::SendCalls);
+            if(r > 0){
+                done += static_cast<size_t>(r);
+                backoff = kMinBackoff;
+            }else if(errno == EAGAIN || errno == EWOULDBLOCK){
+                // Every in-flight batch is still queued; wait for the socket to drain.
+                waitFor(POLLOUT, 100);
+            }else if(errno == ENOBUFS){
+                // The device queue is full, which poll() does not report: the
+                // socket stays writable and POLLOUT would return at once.
+                std::this_thread::sleep_for(backoff);
+                backoff = std::min(backoff * 2, kMaxBackoff);
+            }else if(errno != EINTR){
+                return sent + done;
+            }
+        }
+        sent += n;
+        countMetric(Counter::ChunksSent, n);
+        countMetric(Counter::BytesSent, bytes);
+    }
+    return sent;
+}
+
+size_t BatchTransport::sendRange(const MessageChunksList& list, uint32_t first, uint32_t count, const sockaddr_in& to){
+    Message batch[64];
+    size_t sent = 0;
+    while(sent < count){
+        size_t n = fillChunks(list, first + static_cast<uint32_t>(sent),
+                              std::span<Message>(batch).first(std::min<size_t>(std::size(batch), count - sent)));
+        if(n == 0){
+            break;
+        }
+        size_t r = sendChunks(list, std::span<const Message>(batch, n), to);
+        sent += r;
+        if(r < n){
+            break;
+        }
+    }
+    return sent;
+}
+
+size_t BatchTransport::receiveBatch(std::span<Datagram> out, int timeoutMs){
+    if(!isOpen()){
+        return 0;
+    }
+    unsigned n = static_cast<unsigned>(std::min<size_t>(out.size(), config_.batchSize));
+    for(unsigned i = 0; i < n; ++i){
+        rxMsgs_[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        rxMsgs_[i].msg_hdr.msg_flags = 0;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    int r = recvmmsg(fd_, rxMsgs_.get(), n, MSG_DONTWAIT, nullptr);
+    if(r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && timeoutMs != 0 && waitFor(POLLIN, timeoutMs)){
+        // Time the call that returns data, not the wait before it.
+        start = std::chrono::steady_clock::now();
+        r = recvmmsg(fd_, rxMsgs_.get(), n, MSG_DONTWAIT, nullptr);
+    }
+    if(r <= 0){
+        return 0;
+    }
+    recordStage(Stage::Receive, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now() - start).count()));
+    countMetric(Counter::ReceiveCalls);
+
+    size_t valid = 0;
+    for(int i = 0; i < r; ++i){
+        sockaddr_in from = rxFrom_[i];
+        const uint8_t* bytes = rxSlots_[i].data();
+        size_t len = rxMsgs_[i].msg_len;
+        if(rxMsgs_[i].msg_hdr.msg_flags & MSG_TRUNC){
+            continue;
+        }
+        if(config_.mode == TransportMode::Raw){
+            size_t ipHeader = len ? static_cast<size_t>(bytes[0] & 0x0f) * 4 : 0;
+            if(ipHeader + kRawPortsSize > len){
+                continue;
+            }
+            bytes += ipHeader;
+            len -= ipHeader;
+            uint16_t dstPort;
+            memcpy(&from.sin_port, bytes, 2);
+            memcpy(&dstPort, bytes + 2, 2);
+            if(port_ != 0 && dstPort != port_){
+                continue;
+            }
+            bytes += kRawPortsSize;
+            len -= kRawPortsSize;
+        }
+        Datagram& d = out[valid];
+        if(!decodeChunkHeader({bytes, len}, d.header)){
+            continue;
+        }
+        d.payload = {bytes + kChunkHeaderSize, len - kChunkHeaderSize};
+        d.from = from;
+        ++valid;
+        countMetric(Counter::BytesReceived, d.payload.size());
+    }
+    countMetric(Counter::ChunksReceived, valid);
+    return valid;
+}
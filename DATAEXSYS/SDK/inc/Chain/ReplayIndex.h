@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Identity of one logged chunk.
+struct ReplayKey{
+    uint32_t senderID;
+    uint32_t receiverID;
+    uint32_t transferId;
+    uint32_t seq;   // Message::SeqNum
+};
+
+struct ReplayIndexConfig{
+    uint32_t flowCapacity = 4096;            // tracked (sender, receiver, transfer) flows, power of two
+    uint32_t bloomBits = 1u << 21;           // per generation, power of two
+    uint32_t bloomGenerationKeys = 1u << 17; // inserts before the older generation is dropped
+};
+
+// Constant-time duplicate check for the RouteLogChain.
+//
+// Recent traffic is tracked exactly: every (sender, receiver, transfer) flow
+// keeps a window of the last kWindow sequence numbers as a circular bitmap,
+// like an IPsec anti-replay window. Keys that slide out of a window, or
+// whose flow is evicted from the table, move into a two-generation Bloom
+// filter, so older replays are still caught with a small false-positive
+// rate and bounded memory. A key older than the window that the filter has
+// not seen is accepted and inserted.
+//
+// Evicting a flow also marks it in the filter. A marked flow that comes back
+// starts with an empty window, and it may have logged keys on either side of
+// the seq that reclaimed it. Until the filter has rotated out everything it
+// held at the reclaim, every window miss of that flow is also checked
+// against the filter.
+//
+// flowCapacity and bloomBits must be non-zero powers of two (bloomBits at
+// least 64) and bloomGenerationKeys non-zero; an index built from anything
+// else is not valid() and rejects every key.
+class ReplayIndex{
+public:
+    static constexpr uint32_t kWindow = 1024;
+
+    explicit ReplayIndex(const ReplayIndexConfig& config = {});
+
+    bool valid() const{ return !table_.empty(); }
+
+    // Records key and returns true if it was not seen before; returns false
+    // for a (possible) replay.
+    bool insert(const ReplayKey& key);
+    bool contains(const ReplayKey& key) const;
+
+    size_t flows() const{ return flows_; }
+
+    // Portable big-endian image used for segment checkpoints.
+    std::vector<uint8_t> serialize() const;
+    // Fails if the image is truncated or was taken with a different config.
+    bool restore(std::span<const uint8_t> image);
+
+private:
+    static constexpr uint32_t kWindowWords = kWindow / 64;
+    static constexpr uint32_t kProbe = 8;
+
+    struct Flow{
+        uint32_t senderID;
+        uint32_t receiverID;
+        uint32_t transferId;
+        uint32_t highest;
+        uint64_t lastUse;       // 0 marks a free slot
+        uint64_t filterUntil;   // window misses check the filter while generation_ is below this
+        uint64_t seen[kWindowWords];
+    };
+
+    Flow* find(const ReplayKey& key);
+    const Flow* find(const ReplayKey& key) const;
+    Flow& claim(const ReplayKey& key);
+    void retire(const Flow& flow, uint32_t seq);
+    void retireAll(const Flow& flow);
+
+    bool filtered(const Flow& flow) const{ return generation_ < flow.filterUntil; }
+    bool bloomContains(uint64_t hash) const;
+    void bloomInsert(uint64_t hash);
+
+    ReplayIndexConfig config_;
+    std::vector<Flow> table_;
+    size_t flows_ = 0;
+    uint64_t clock_ = 0;
+    std::vector<uint64_t> bloom_[2];
+    uint32_t current_ = 0;
+    uint64_t generation_ = 0;   // filter rotations so far
+    uint32_t currentKeys_ = 0;
+};
@@ -0,0 +1,116 @@
+#pragma once
+#include "Chain/ReplayIndex.h"
+#include "Crypto/Sha256.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+constexpr size_t kMaxRouteHops = 16;
+
+// One received chunk and the path it took.
+struct RouteRecord{
+    uint32_t senderID;
+    uint32_t receiverID;
+    uint32_t transferId;
+    uint32_t seq;         // Message::SeqNum
+    uint64_t timestamp;   // caller's clock
+    uint8_t hopCount;
+    uint32_t hops[kMaxRouteHops];
+};
+
+inline ReplayKey replayKey(const RouteRecord& record){
+    return ReplayKey{record.senderID, record.receiverID, record.transferId, record.seq};
+}
+
+enum class LogResult : uint8_t{
+    Logged,
+    Replay,    // already logged; drop the chunk
+    Invalid,   // too many hops
+    Failed,    // chain not open, or the next segment could not be created
+};
+
+struct RouteLogConfig{
+    size_t segmentBytes = 64 << 20;
+    uint32_t blockRecords = 1024;   // most records hashed into one block
+    bool syncOnSeal = true;         // make a block durable before recording its hash
+    ReplayIndexConfig index;
+};
+
+struct RouteLogRecovery{
+    bool fromCheckpoint = false;
+    uint32_t segmentsScanned = 0;
+    uint64_t recordsReplayed = 0;
+};
+
+// RouteLogChain storage engine.
+//
+// Records are appended to fixed-size segment files (route-N.seg) through a
+// shared mapping; the receive path only checks the replay index, encodes
+// the record and publishes the new end of the segment. Hashing happens in
+// sealPending(), which is meant to run on another thread: it cuts the
+// records appended since the last call into blocks, chains each block's
+// SHA-256 to the previous one and appends it to the segment's block file
+// (route-N.blk).
+//
+// When a segment fills up, the replay index is checkpointed next to it
+// (route-N.idx). Opening the chain loads the newest checkpoint and replays
+// only the segments written after it, so startup cost is bounded by one
+// segment rather than the whole chain. A torn record at the tail ends the
+// log and is zeroed.
+//
+// log() and seen() belong to a single receive thread; sealPending(), head()
+// and verify() may be called from any other thread. A config whose segments
+// cannot hold a full record, with blockRecords == 0 or an invalid index
+// config leaves the chain closed (isOpen() is false).
+class RouteLogChain{
+public:
+    explicit RouteLogChain(std::string directory, const RouteLogConfig& config = {});
+    ~RouteLogChain();
+
+    RouteLogChain(const RouteLogChain&) = delete;
+    RouteLogChain& operator=(const RouteLogChain&) = delete;
+
+    bool isOpen() const{ return active_ != nullptr; }
+    const RouteLogRecovery& recovery() const{ return recovery_; }
+
+    LogResult log(const RouteRecord& record);
+    bool seen(const ReplayKey& key) const{ return index_.contains(key); }
+
+    // Seals everything appended so far; returns the number of blocks written.
+    size_t sealPending();
+
+    Sha256Digest head() const;
+    uint64_t blocks() const;
+
+    // Re-hashes every sealed block on disk against the chain.
+    bool verify() const;
+
+private:
+    struct Segment;
+
+    std::string segmentPath(uint64_t number, const char* suffix) const;
+    std::unique_ptr<Segment> openSegment(uint64_t number, bool create);
+    bool recover();
+    bool rotate();
+    bool writeCheckpoint(uint64_t number) const;
+    bool loadCheckpoint(uint64_t number);
+    bool sealBlock(Segment& segment, uint64_t end);
+    bool appendBlock(Segment& segment, uint64_t start, uint64_t end, uint32_t records, bool final);
+
+    std::string directory_;
+    RouteLogConfig config_;
+    ReplayIndex index_;
+    RouteLogRecovery recovery_;
+
+    Segment* active_ = nullptr;   // owned by segments_, written by log()
+    std::mutex segmentsMutex_;
+    std::deque<std::unique_ptr<Segment>> segments_;   // oldest not yet fully sealed first
+
+    mutable std::mutex sealMutex_;
+    Sha256Digest head_{};
+    uint64_t blocks_ = 0;
+};
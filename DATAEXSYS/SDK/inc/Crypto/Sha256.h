@@ -0,0 +1,26 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+using Sha256Digest = std::array<uint8_t, 32>;
+
+// Incremental SHA-256 (FIPS 180-4) for chain block hashes.
+class Sha256{
+public:
+    Sha256();
+
+    void update(std::span<const uint8_t> bytes);
+    Sha256Digest finish();
+
+    static Sha256Digest hash(std::span<const uint8_t> bytes);
+
+private:
+    void compress(const uint8_t* block);
+
+    uint32_t state_[8];
+    uint8_t buffer_[64];
+    size_t buffered_ = 0;
+    uint64_t length_ = 0;
+};
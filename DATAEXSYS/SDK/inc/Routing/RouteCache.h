@@ -0,0 +1,101 @@
+#pragma once
+#include "Routing/RouteGraph.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+class TrustDiary;
+
+// Relative weight of each metric in a link's cost. A link u -> v costs
+//   hop + trust * -ln(trust(v)) + quality * -ln(quality(u -> v))
+// so a path's cost is additive and minimizing it trades path length against
+// the chance that every relay forwards and every link delivers.
+struct RouteWeights{
+    double hop = 1.0;
+    double trust = 4.0;
+    double quality = 2.0;
+};
+
+struct RouteRepairStats{
+    uint32_t invalidated = 0;   // nodes cut from the tree by a cost increase
+    uint32_t settled = 0;       // nodes whose route was recomputed
+};
+
+// Shortest-path tree from one source over a RouteGraph, i.e. the DSR route
+// cache of this node. Routes are stored as a parent array (one u32 per
+// destination) and expanded into a source route on lookup.
+//
+// Trust and link quality are quantized to kLevels steps, which keeps costs
+// integral (repairs and full recomputes agree exactly) and means trust
+// drifting inside a step does not touch the tree. Changes are repaired
+// incrementally: a cheaper edge propagates from its head, a dearer tree edge
+// cuts its subtree loose and re-seeds it from the surrounding tree.
+class RouteCache{
+public:
+    static constexpr uint32_t kLevels = 64;
+    static constexpr uint32_t kNoNode = std::numeric_limits<uint32_t>::max();
+    static constexpr uint64_t kUnreachable = std::numeric_limits<uint64_t>::max();
+
+    RouteCache(RouteGraph graph, uint32_t source, const RouteWeights& weights = {});
+
+    const RouteGraph& graph() const{ return graph_; }
+    uint32_t source() const{ return source_; }
+
+    uint64_t cost(uint32_t destination) const{ return dist_[destination]; }
+    bool reachable(uint32_t destination) const{ return dist_[destination] != kUnreachable; }
+    uint32_t nextHop(uint32_t destination) const;
+
+    // Writes the source route to destination (relays, then destination; the
+    // source itself is left out) and returns its length. Returns 0 if the
+    // destination is unreachable or the route does not fit in out.
+    size_t route(uint32_t destination, std::span<uint32_t> out) const;
+
+    // Unknown nodes and links are ignored.
+    void setTrust(uint32_t node, double trust);
+    // Applies every changed trust level in one repair.
+    void syncTrust(const TrustDiary& diary);
+    // quality 0 takes the link down.
+    void setLinkQuality(uint32_t from, uint32_t to, double quality);
+
+    // Full Dijkstra; the baseline the repairs are measured against.
+    void recompute();
+
+    const RouteRepairStats& lastRepair() const{ return stats_; }
+
+private:
+    static constexpr uint32_t kDown = std::numeric_limits<uint32_t>::max();
+
+    struct Pending{
+        uint64_t dist;
+        uint32_t node;
+        bool operator>(const Pending& other) const{ return dist > other.dist; }
+    };
+
+    static uint8_t level(double value);
+    uint32_t weightOf(uint32_t edge, uint32_t head) const;
+    // Recomputes the weights of the given edges and repairs the tree.
+    void reweigh(std::span<const uint32_t> edges);
+    void invalidate(uint32_t root);
+    void offer(uint32_t node, uint64_t dist, uint32_t parent, uint32_t edge);
+    void settle();
+
+    RouteGraph graph_;
+    uint32_t source_;
+    uint32_t hopCost_;
+    std::array<uint32_t, kLevels + 1> trustCost_;
+    std::array<uint32_t, kLevels + 1> qualityCost_;
+    std::vector<uint8_t> trustLevel_;   // per node
+
+    std::vector<uint64_t> dist_;
+    std::vector<uint32_t> parent_;
+    std::vector<uint32_t> parentEdge_;
+
+    std::vector<Pending> heap_;
+    std::vector<uint32_t> scratch_;
+    std::vector<uint32_t> changed_;
+    std::vector<uint32_t> trustEdges_;   // in-edges of nodes whose trust moved
+    RouteRepairStats stats_;
+};
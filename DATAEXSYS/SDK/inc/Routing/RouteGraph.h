@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Directed radio link as observed by the routing layer.
+struct Link{
+    uint32_t from;
+    uint32_t to;
+    float quality;   // delivery ratio in [0, 1]; 0 means down
+};
+
+// Compressed sparse row adjacency. Out-arcs of a node are contiguous and
+// carry their current weight inline, so a Dijkstra relaxation touches one
+// array; in-arcs point back at the forward edge index for repairs.
+class RouteGraph{
+public:
+    struct Arc{
+        uint32_t head;
+        uint32_t weight;
+    };
+    struct InArc{
+        uint32_t tail;
+        uint32_t edge;
+    };
+
+    RouteGraph() = default;
+    // Links with an endpoint outside [0, nodes) are dropped.
+    RouteGraph(uint32_t nodes, std::span<const Link> links);
+
+    uint32_t nodes() const{ return static_cast<uint32_t>(offsets_.size() - 1); }
+    uint32_t edges() const{ return static_cast<uint32_t>(arcs_.size()); }
+
+    std::span<const Arc> out(uint32_t node) const{
+        return {arcs_.data() + offsets_[node], arcs_.data() + offsets_[node + 1]};
+    }
+    std::span<const InArc> in(uint32_t node) const{
+        return {inArcs_.data() + inOffsets_[node], inArcs_.data() + inOffsets_[node + 1]};
+    }
+    // Edge indices of node's out-arcs are [firstEdge(node), firstEdge(node + 1)).
+    uint32_t firstEdge(uint32_t node) const{ return offsets_[node]; }
+
+    const Arc& arc(uint32_t edge) const{ return arcs_[edge]; }
+    uint32_t tail(uint32_t edge) const;
+    // Edge index of from -> to, or edges() if there is no such link.
+    uint32_t find(uint32_t from, uint32_t to) const;
+
+    float quality(uint32_t edge) const{ return quality_[edge]; }
+    void setQuality(uint32_t edge, float quality){ quality_[edge] = quality; }
+    void setWeight(uint32_t edge, uint32_t weight){ arcs_[edge].weight = weight; }
+
+private:
+    std::vector<uint32_t> offsets_{0};
+    std::vector<Arc> arcs_;
+    std::vector<float> quality_;
+    std::vector<uint32_t> inOffsets_{0};
+    std::vector<InArc> inArcs_;
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include "Routing/RouteGraph.h"
+#include <cstdint>
+#include <vector>
+
+// splitmix64: tiny, fast and identical on every platform, so a seed names
+// the same topology everywhere.
+struct SplitMix64{
+    uint64_t state;
+
+    uint64_t next(){
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+    // Uniform in [0, 1).
+    double unit(){ return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+};
+
+struct TopologyConfig{
+    uint32_t nodes = 1000;
+    double averageDegree = 8.0;
+    uint64_t seed = 1;
+};
+
+struct Topology{
+    uint32_t nodes = 0;
+    std::vector<Link> links;
+    std::vector<float> trust;   // per node, mostly honest with a few bad actors
+};
+
+// Random geometric graph in the unit square, the usual stand-in for an
+// ad-hoc radio network: nodes within radio range are linked both ways, and
+// link quality falls off with distance (with some asymmetry per direction).
+Topology generateTopology(const TopologyConfig& config);
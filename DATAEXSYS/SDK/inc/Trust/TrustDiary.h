@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+// Bayesian Trust Diary: a Beta(alpha, beta) reputation per neighbor, where
+// alpha counts forwarded packets and beta dropped ones.
+//
+// The table is dense and indexed by node ID. Each node's evidence lives in a
+// single 64-bit word, [epoch:20][alpha:22][beta:22] with alpha and beta in
+// 14.8 fixed point, so a routing-path read is one atomic load (wait-free)
+// and writers merge outcomes with a CAS (lock-free across cores). Time decay
+// is lazy: a word remembers the epoch it was last written in, and readers
+// and writers scale its evidence by decayPerEpoch^age on the fly. Ages are
+// taken on the 20-bit epoch ring: a word from a later epoch than the reader's
+// (a racing writer) counts as age 0, and advanceEpoch() clears fully decayed
+// words before their stored epoch can wrap round to look fresh.
+
+struct TrustConfig{
+    double priorAlpha = 1.0;
+    double priorBeta = 1.0;
+    double decayPerEpoch = 0.98;   // 1.0 disables decay; above ~0.99994 is clamped to that
+};
+
+// Outcomes observed for one neighbor since the last batch.
+struct TrustOutcome{
+    uint32_t node;
+    uint16_t forwarded;
+    uint16_t dropped;
+};
+
+struct TrustCounts{
+    double alpha;   // prior included
+    double beta;
+};
+
+class TrustDiary{
+public:
+    // uint8_t node IDs need the default 256 entries; wider IDs just size up.
+    explicit TrustDiary(size_t capacity = 256, const TrustConfig& config = {});
+
+    size_t capacity() const{ return capacity_; }
+    const TrustConfig& config() const{ return config_; }
+
+    uint32_t epoch() const{ return epoch_.load(std::memory_order_relaxed); }
+    void advanceEpoch(uint32_t by = 1);
+
+    // Posterior mean alpha / (alpha + beta). Wait-free; unknown or
+    // out-of-range nodes report the prior.
+    double trust(uint32_t node) const;
+    TrustCounts counts(uint32_t node) const;
+
+    void record(uint32_t node, bool forwarded);
+
+    // Merges a batch of outcomes. Consecutive entries for the same node are
+    // folded into a single CAS.
+    void applyBatch(std::span<const TrustOutcome> outcomes);
+
+    // Portable big-endian image of the whole table.
+    size_t snapshotSize() const;
+    void snapshot(std::span<uint8_t> out) const;
+    std::vector<uint8_t> snapshot() const;
+    // Fails if the image is truncated or was taken from a different capacity.
+    bool restore(std::span<const uint8_t> image);
+
+private:
+    struct Evidence{
+        uint32_t alpha;   // 14.8 fixed point
+        uint32_t beta;
+    };
+
+    Evidence decayed(uint64_t word, uint32_t now) const;
+    // Zeroes every word whose evidence has fully decayed at now; with all,
+    // every word (a batch merged concurrently may be lost with them).
+    void expire(uint32_t now, bool all);
+
+    size_t capacity_;
+    TrustConfig config_;
+    std::atomic<uint32_t> epoch_{0};
+    std::unique_ptr<std::atomic<uint64_t>[]> evidence_;
+    std::vector<uint32_t> decay_;   // Q16 multiplier per epoch of age
+};
@@ -0,0 +1,314 @@
+#include "Chain/ReplayIndex.h"
+#include "App/Classes/Message.h"
+#include "Helper/WireCodec.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace {
+
+constexpr unsigned kBloomProbes = 4;
+
+constexpr uint32_t kImageMagic = 0x52505833;   // "RPX3"
+constexpr size_t kImageHeader = 44;
+constexpr size_t kFlowImage = 5 * 4 + 2 * 8 + ReplayIndex::kWindow / 8;
+
+constexpr uint64_t mix(uint64_t x){
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+uint64_t flowHash(uint32_t senderID, uint32_t receiverID, uint32_t transferId){
+    return mix((uint64_t{senderID} << 32 | receiverID) ^ mix(transferId));
+}
+
+uint64_t keyHash(const ReplayKey& key){
+    return mix(flowHash(key.senderID, key.receiverID, key.transferId) ^ key.seq);
+}
+
+// Filter entry recording that a flow was evicted; no sequence number hashes to it.
+uint64_t evictedHash(uint32_t senderID, uint32_t receiverID, uint32_t transferId){
+    return mix(flowHash(senderID, receiverID, transferId) + 0x4556494354ull);
+}
+
+bool sameFlow(uint32_t senderID, uint32_t receiverID, uint32_t transferId, const ReplayKey& key){
+    return senderID == key.senderID && receiverID == key.receiverID && transferId == key.transferId;
+}
+
+bool validConfig(const ReplayIndexConfig& config){
+    return std::has_single_bit(config.flowCapacity) && std::has_single_bit(config.bloomBits) && config.bloomBits >= 64
+           && config.bloomGenerationKeys != 0;
+}
+
+}
+
+ReplayIndex::ReplayIndex(const ReplayIndexConfig& config)
+    : config_(config){
+    if(!validConfig(config_)){
+        return;
+    }
+    table_.resize(config_.flowCapacity);
+    bloom_[0].assign(config_.bloomBits / 64, 0);
+    bloom_[1].assign(config_.bloomBits / 64, 0);
+}
+
+const ReplayIndex::Flow* ReplayIndex::find(const ReplayKey& key) const{
+    size_t mask = table_.size() - 1;
+    size_t slot = flowHash(key.senderID, key.receiverID, key.transferId) & mask;
+    for(uint32_t i = 0; i < kProbe; ++i, slot = (slot + 1) & mask){
+        const Flow& flow = table_[slot];
+        // Flows are only ever replaced, never removed, so a free slot ends the probe.
+        if(!flow.lastUse){
+            return nullptr;
+        }
+        if(sameFlow(flow.senderID, flow.receiverID, flow.transferId, key)){
+            return &flow;
+        }
+    }
+    return nullptr;
+}
+
+ReplayIndex::Flow* ReplayIndex::find(const ReplayKey& key){
+    return const_cast<Flow*>(static_cast<const ReplayIndex*>(this)->find(key));
+}
+
+ReplayIndex::Flow& ReplayIndex::claim(const ReplayKey& key){
+    size_t mask = table_.size() - 1;
+    size_t slot = flowHash(key.senderID, key.receiverID, key.transferId) & mask;
+    Flow* victim = &table_[slot];
+    for(uint32_t i = 0; i < kProbe; ++i, slot = (slot + 1) & mask){
+        Flow& flow = table_[slot];
+        if(!flow.lastUse){
+            victim = &flow;
+            ++flows_;
+            break;
+        }
+        if(flow.lastUse < victim->lastUse){
+            victim = &flow;
+        }
+    }
+    if(victim->lastUse){
+        // The marker goes in after the flow's keys, so it outlives them.
+        retireAll(*victim);
+        bloomInsert(evictedHash(victim->senderID, victim->receiverID, victim->transferId));
+    }
+
+    victim->senderID = key.senderID;
+    victim->receiverID = key.receiverID;
+    victim->transferId = key.transferId;
+    victim->highest = key.seq;
+    // Both generations drop out of the filter within two rotations.
+    victim->filterUntil = bloomContains(evictedHash(key.senderID, key.receiverID, key.transferId)) ? generation_ + 2 : 0;
+    memset(victim->seen, 0, sizeof(victim->seen));
+    return *victim;
+}
+
+void ReplayIndex::retire(const Flow& flow, uint32_t seq){
+    bloomInsert(keyHash(ReplayKey{flow.senderID, flow.receiverID, flow.transferId, seq}));
+}
+
+void ReplayIndex::retireAll(const Flow& flow){
+    for(uint32_t word = 0; word < kWindowWords; ++word){
+        for(uint64_t bits = flow.seen[word]; bits; bits &= bits - 1){
+            uint32_t slot = word * 64 + static_cast<uint32_t>(std::countr_zero(bits));
+            // The window slot holds the most recent sequence number congruent to it.
+            retire(flow, flow.highest - ((flow.highest - slot) % kWindow));
+        }
+    }
+}
+
+bool ReplayIndex::insert(const ReplayKey& key){
+    if(!valid()){
+        return false;
+    }
+    ++clock_;
+    uint64_t hash = keyHash(key);
+    Flow* flow = find(key);
+    if(!flow){
+        if(bloomContains(hash)){
+            return false;
+        }
+        flow = &claim(key);
+    }
+    flow->lastUse = clock_;
+
+    if(seqBefore(flow->highest, key.seq)){
+        if(filtered(*flow) && bloomContains(hash)){
+            return false;
+        }
+        if(seqDistance(flow->highest, key.seq) >= kWindow){
+            retireAll(*flow);
+            memset(flow->seen, 0, sizeof(flow->seen));
+        }else{
+            // Each slot the window slides over still holds seq - kWindow.
+            for(uint32_t seq = flow->highest + 1; seq != key.seq + 1; ++seq){
+                uint32_t slot = seq % kWindow;
+                uint64_t bit = uint64_t{1} << (slot % 64);
+                if(flow->seen[slot / 64] & bit){
+                    retire(*flow, seq - kWindow);
+                    flow->seen[slot / 64] &= ~bit;
+                }
+            }
+        }
+        flow->highest = key.seq;
+    }else if(seqDistance(key.seq, flow->highest) >= kWindow){
+        if(bloomContains(hash)){
+            return false;
+        }
+        bloomInsert(hash);
+        return true;
+    }
+
+    uint32_t slot = key.seq % kWindow;
+    uint64_t bit = uint64_t{1} << (slot % 64);
+    if(flow->seen[slot / 64] & bit){
+        return false;
+    }
+    if(filtered(*flow) && bloomContains(hash)){
+        return false;
+    }
+    flow->seen[slot / 64] |= bit;
+    return true;
+}
+
+bool ReplayIndex::contains(const ReplayKey& key) const{
+    if(!valid()){
+        return false;
+    }
+    const Flow* flow = find(key);
+    if(flow){
+        bool ahead = seqBefore(flow->highest, key.seq);
+        if(!ahead && seqDistance(key.seq, flow->highest) >= kWindow){
+            return bloomContains(keyHash(key));
+        }
+        uint32_t slot = key.seq % kWindow;
+        if(!ahead && flow->seen[slot / 64] >> (slot % 64) & 1){
+            return true;
+        }
+        // A window miss: only a reclaimed flow can have logged it before.
+        if(!filtered(*flow)){
+            return false;
+        }
+    }
+    return bloomContains(keyHash(key));
+}
+
+bool ReplayIndex::bloomContains(uint64_t h) const{
+    uint32_t h1 = static_cast<uint32_t>(h);
+    uint32_t h2 = static_cast<uint32_t>(h >> 32) | 1;
+    uint32_t mask = config_.bloomBits - 1;
+    for(const std::vector<uint64_t>& bloom : bloom_){
+        bool all = true;
+        for(unsigned i = 0; i < kBloomProbes && all; ++i){
+            uint32_t bit = (h1 + i * h2) & mask;
+            all = bloom[bit / 64] >> (bit % 64) & 1;
+        }
+        if(all){
+            return true;
+        }
+    }
+    return false;
+}
+
+void ReplayIndex::bloomInsert(uint64_t h){
+    uint32_t h1 = static_cast<uint32_t>(h);
+    uint32_t h2 = static_cast<uint32_t>(h >> 32) | 1;
+    uint32_t mask = config_.bloomBits - 1;
+    std::vector<uint64_t>& bloom = bloom_[current_];
+    for(unsigned i = 0; i < kBloomProbes; ++i){
+        uint32_t bit = (h1 + i * h2) & mask;
+        bloom[bit / 64] |= uint64_t{1} << (bit % 64);
+    }
+
+    // The filter slides by generations: once the current one is full, the
+    // older one is dropped and reused.
+    if(++currentKeys_ >= config_.bloomGenerationKeys){
+        current_ ^= 1;
+        std::fill(bloom_[current_].begin(), bloom_[current_].end(), 0);
+        currentKeys_ = 0;
+        ++generation_;
+    }
+}
+
+std::vector<uint8_t> ReplayIndex::serialize() const{
+    size_t bloomWords = bloom_[0].size();
+    std::vector<uint8_t> image(kImageHeader + flows_ * kFlowImage + 2 * bloomWords * sizeof(uint64_t));
+    uint8_t* ptr = image.data();
+    storeBE<uint32_t>(ptr, kImageMagic);
+    storeBE<uint32_t>(ptr + 4, config_.flowCapacity);
+    storeBE<uint32_t>(ptr + 8, config_.bloomBits);
+    storeBE<uint32_t>(ptr + 12, config_.bloomGenerationKeys);
+    storeBE<uint32_t>(ptr + 16, current_);
+    storeBE<uint32_t>(ptr + 20, currentKeys_);
+    storeBE<uint64_t>(ptr + 24, clock_);
+    storeBE<uint32_t>(ptr + 32, static_cast<uint32_t>(flows_));
+    storeBE<uint64_t>(ptr + 36, generation_);
+    ptr += kImageHeader;
+
+    for(size_t slot = 0; slot < table_.size(); ++slot){
+        const Flow& flow = table_[slot];
+        if(!flow.lastUse){
+            continue;
+        }
+        storeBE<uint32_t>(ptr, static_cast<uint32_t>(slot));
+        storeBE<uint32_t>(ptr + 4, flow.senderID);
+        storeBE<uint32_t>(ptr + 8, flow.receiverID);
+        storeBE<uint32_t>(ptr + 12, flow.transferId);
+        storeBE<uint32_t>(ptr + 16, flow.highest);
+        storeBE<uint64_t>(ptr + 20, flow.lastUse);
+        storeBE<uint64_t>(ptr + 28, flow.filterUntil);
+        storeBE<uint64_t>(ptr + 36, std::span<const uint64_t>(flow.seen));
+        ptr += kFlowImage;
+    }
+    for(const std::vector<uint64_t>& bloom : bloom_){
+        storeBE<uint64_t>(ptr, std::span<const uint64_t>(bloom));
+        ptr += bloomWords * sizeof(uint64_t);
+    }
+    return image;
+}
+
+bool ReplayIndex::restore(std::span<const uint8_t> image){
+    const uint8_t* ptr = image.data();
+    if(image.size() < kImageHeader || loadBE<uint32_t>(ptr) != kImageMagic
+       || loadBE<uint32_t>(ptr + 4) != config_.flowCapacity || loadBE<uint32_t>(ptr + 8) != config_.bloomBits
+       || loadBE<uint32_t>(ptr + 12) != config_.bloomGenerationKeys){
+        return false;
+    }
+    size_t flows = loadBE<uint32_t>(ptr + 32);
+    size_t bloomWords = bloom_[0].size();
+    if(flows > table_.size() || image.size() != kImageHeader + flows * kFlowImage + 2 * bloomWords * sizeof(uint64_t)){
+        return false;
+    }
+    current_ = loadBE<uint32_t>(ptr + 16) & 1;
+    currentKeys_ = loadBE<uint32_t>(ptr + 20);
+    clock_ = loadBE<uint64_t>(ptr + 24);
+    generation_ = loadBE<uint64_t>(ptr + 36);
+    ptr += kImageHeader;
+
+    // Flows go back to the slots they were saved from, so probe chains are
+    // exactly as they were.
+    std::fill(table_.begin(), table_.end(), Flow{});
+    flows_ = flows;
+    for(size_t i = 0; i < flows; ++i, ptr += kFlowImage){
+        uint32_t slot = loadBE<uint32_t>(ptr);
+        if(slot >= table_.size()){
+            return false;
+        }
+        Flow& flow = table_[slot];
+        flow.senderID = loadBE<uint32_t>(ptr + 4);
+        flow.receiverID = loadBE<uint32_t>(ptr + 8);
+        flow.transferId = loadBE<uint32_t>(ptr + 12);
+        flow.highest = loadBE<uint32_t>(ptr + 16);
+        flow.lastUse = loadBE<uint64_t>(ptr + 20);
+        flow.filterUntil = loadBE<uint64_t>(ptr + 28);
+        loadBE<uint64_t>(std::span<uint64_t>(flow.seen), ptr + 36);
+    }
+    for(std::vector<uint64_t>& bloom : bloom_){
+        loadBE<uint64_t>(std::span<uint64_t>(bloom), ptr);
+        ptr += bloomWords * sizeof(uint64_t);
+    }
+    return true;
+}
@@ -0,0 +1,584 @@
+#include "Chain/RouteLogChain.h"
+#include "Helper/WireCodec.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <optional>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// route-N.seg: [u32 magic][u16 version][u16 reserved][u64 segment number] then records.
+constexpr uint32_t kSegmentMagic = 0x524c5331;   // "RLS1"
+constexpr uint16_t kSegmentVersion = 1;
+constexpr uint64_t kSegmentHeader = 16;
+
+// Record: [u32 body length][u8 type][body][u32 FNV-1a of everything before it].
+// A zero length marks the end of the log.
+constexpr uint64_t kRecordFrame = 9;
+constexpr uint8_t kRecordRoute = 1;
+// Route body: sender, receiver, transfer, seq, u64 timestamp, u8 hop count, u32 hops.
+constexpr size_t kRouteFixed = 25;
+
+// Largest record log() writes.
+constexpr uint64_t kMaxRecord = kRecordFrame + kRouteFixed + 4 * kMaxRouteHops;
+
+// route-N.blk entry: [u64 block][u64 start][u64 end][u32 records][u32 flags][hash][u64 check].
+// A final entry closes a fully sealed segment and repeats the head.
+constexpr size_t kBlockEntry = 72;
+constexpr uint32_t kBlockFinal = 1;
+
+// route-N.idx: [u32 magic][u32 reserved][u64 segment number][u64 checksum] then the index image.
+constexpr uint32_t kCheckpointMagic = 0x524c4931;   // "RLI1"
+constexpr size_t kCheckpointHeader = 24;
+
+struct BlockEntry{
+    uint64_t block;
+    uint64_t start;
+    uint64_t end;
+    uint32_t records;
+    uint32_t flags;
+    Sha256Digest hash;
+};
+
+uint32_t fnv1a(const uint8_t* bytes, size_t size){
+    uint32_t h = 0x811c9dc5;
+    for(size_t i = 0; i < size; ++i){
+        h = (h ^ bytes[i]) * 0x01000193;
+    }
+    return h;
+}
+
+uint64_t checksum(std::span<const uint8_t> bytes){
+    uint64_t h = 0xcbf29ce484222325ull ^ bytes.size();
+    size_t i = 0;
+    for(; i + 8 <= bytes.size(); i += 8){
+        h = (h ^ loadBE<uint64_t>(bytes.data() + i)) * 0x100000001b3ull;
+        h ^= h >> 29;
+    }
+    for(; i < bytes.size(); ++i){
+        h = (h ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return h;
+}
+
+void encodeBlock(const BlockEntry& entry, uint8_t* out){
+    storeBE<uint64_t>(out, entry.block);
+    storeBE<uint64_t>(out + 8, entry.start);
+    storeBE<uint64_t>(out + 16, entry.end);
+    storeBE<uint32_t>(out + 24, entry.records);
+    storeBE<uint32_t>(out + 28, entry.flags);
+    memcpy(out + 32, entry.hash.data(), entry.hash.size());
+    storeBE<uint64_t>(out + 64, checksum({out, 64}));
+}
+
+bool decodeBlock(const uint8_t* in, BlockEntry& entry){
+    if(loadBE<uint64_t>(in + 64) != checksum({in, 64})){
+        return false;
+    }
+    entry.block = loadBE<uint64_t>(in);
+    entry.start = loadBE<uint64_t>(in + 8);
+    entry.end = loadBE<uint64_t>(in + 16);
+    entry.records = loadBE<uint32_t>(in + 24);
+    entry.flags = loadBE<uint32_t>(in + 28);
+    memcpy(entry.hash.data(), in + 32, entry.hash.size());
+    return true;
+}
+
+// Size of the intact record at offset, or 0 at the end of the log.
+uint64_t recordAt(const uint8_t* base, uint64_t capacity, uint64_t offset){
+    if(capacity - offset < kRecordFrame){
+        return 0;
+    }
+    uint32_t body = loadBE<uint32_t>(base + offset);
+    if(body == 0 || body > capacity - offset - kRecordFrame
+       || loadBE<uint32_t>(base + offset + 5 + body) != fnv1a(base + offset, 5 + body)){
+        return 0;
+    }
+    return kRecordFrame + body;
+}
+
+ReplayKey routeKey(const uint8_t* record){
+    const uint8_t* body = record + 5;
+    return ReplayKey{loadBE<uint32_t>(body), loadBE<uint32_t>(body + 4), loadBE<uint32_t>(body + 8), loadBE<uint32_t>(body + 12)};
+}
+
+bool readFile(const std::string& path, std::vector<uint8_t>& out){
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0){
+        return false;
+    }
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0;
+    if(ok){
+        out.resize(static_cast<size_t>(st.st_size));
+        size_t done = 0;
+        while(ok && done < out.size()){
+            ssize_t n = pread(fd, out.data() + done, out.size() - done, static_cast<off_t>(done));
+            ok = n > 0;
+            done += ok ? static_cast<size_t>(n) : 0;
+        }
+    }
+    close(fd);
+    return ok;
+}
+
+bool writeAll(int fd, const uint8_t* bytes, size_t size){
+    while(size){
+        ssize_t n = write(fd, bytes, size);
+        if(n <= 0){
+            return false;
+        }
+        bytes += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Leading run of intact entries in a block file.
+std::vector<BlockEntry> readBlocks(const std::string& path){
+    std::vector<uint8_t> bytes;
+    std::vector<BlockEntry> entries;
+    if(!readFile(path, bytes)){
+        return entries;
+    }
+    BlockEntry entry;
+    for(size_t offset = 0; offset + kBlockEntry <= bytes.size() && decodeBlock(bytes.data() + offset, entry); offset += kBlockEntry){
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+std::vector<uint64_t> listNumbered(const std::string& directory, const char* suffix){
+    std::vector<uint64_t> numbers;
+    std::error_code ec;
+    for(const auto& file : std::filesystem::directory_iterator(directory, ec)){
+        std::string name = file.path().filename().string();
+        unsigned long long number;
+        char tail[8];
+        if(sscanf(name.c_str(), "route-%llu%7s", &number, tail) == 2 && strcmp(tail, suffix) == 0){
+            numbers.push_back(number);
+        }
+    }
+    std::sort(numbers.begin(), numbers.end());
+    return numbers;
+}
+
+// A segment must hold its header and at least one record, and a block at
+// least one record, or log() and sealPending() cannot make progress.
+bool validConfig(const RouteLogConfig& config){
+    return config.segmentBytes >= kSegmentHeader + kMaxRecord && config.blockRecords != 0;
+}
+
+uint64_t pageAlignDown(uint64_t offset){
+    uint64_t page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    return offset / page * page;
+}
+
+}
+
+struct RouteLogChain::Segment{
+    uint64_t number = 0;
+    int fd = -1;
+    int blockFd = -1;
+    uint8_t* base = nullptr;
+    uint64_t capacity = 0;
+    std::atomic<uint64_t> end{kSegmentHeader};   // published by log(), read by the sealer
+    std::atomic<bool> closed{false};
+    uint64_t sealedEnd = kSegmentHeader;         // sealer-owned
+    uint64_t blockEntries = 0;
+
+    ~Segment(){
+        if(base){
+            munmap(base, capacity);
+        }
+        if(fd >= 0){
+            close(fd);
+        }
+        if(blockFd >= 0){
+            close(blockFd);
+        }
+    }
+};
+
+RouteLogChain::RouteLogChain(std::string directory, const RouteLogConfig& config)
+    : directory_(std::move(directory)), config_(config), index_(config.index){
+    if(!validConfig(config_) || !index_.valid() || !recover()){
+        active_ = nullptr;
+        segments_.clear();
+    }
+}
+
+RouteLogChain::~RouteLogChain() = default;
+
+std::string RouteLogChain::segmentPath(uint64_t number, const char* suffix) const{
+    char name[40];
+    snprintf(name, sizeof(name), "route-%08llu%s", static_cast<unsigned long long>(number), suffix);
+    return directory_ + "/" + name;
+}
+
+std::unique_ptr<RouteLogChain::Segment> RouteLogChain::openSegment(uint64_t number, bool create){
+    auto segment = std::make_unique<Segment>();
+    segment->number = number;
+
+    int flags = O_RDWR | O_CLOEXEC | (create ? O_CREAT | O_TRUNC : 0);
+    segment->fd = open(segmentPath(number, ".seg").c_str(), flags, 0644);
+    if(segment->fd < 0){
+        return nullptr;
+    }
+    if(create){
+        segment->capacity = config_.segmentBytes;
+        if(ftruncate(segment->fd, static_cast<off_t>(segment->capacity)) != 0){
+            return nullptr;
+        }
+    }else{
+        struct stat st;
+        if(fstat(segment->fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < kSegmentHeader){
+            return nullptr;
+        }
+        segment->capacity = static_cast<uint64_t>(st.st_size);
+    }
+
+    void* base = mmap(nullptr, segment->capacity, PROT_READ | PROT_WRITE, MAP_SHARED, segment->fd, 0);
+    if(base == MAP_FAILED){
+        return nullptr;
+    }
+    segment->base = static_cast<uint8_t*>(base);
+    madvise(base, segment->capacity, MADV_SEQUENTIAL);
+
+    if(create){
+        storeBE<uint32_t>(segment->base, kSegmentMagic);
+        storeBE<uint16_t>(segment->base + 4, kSegmentVersion);
+        storeBE<uint64_t>(segment->base + 8, number);
+    }else if(loadBE<uint32_t>(segment->base) != kSegmentMagic || loadBE<uint64_t>(segment->base + 8) != number){
+        return nullptr;
+    }
+
+    segment->blockFd = open(segmentPath(number, ".blk").c_str(), O_RDWR | O_CREAT | O_CLOEXEC | (create ? O_TRUNC : 0), 0644);
+    if(segment->blockFd < 0){
+        return nullptr;
+    }
+    return segment;
+}
+
+bool RouteLogChain::recover(){
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+
+    std::vector<uint64_t> numbers = listNumbered(directory_, ".seg");
+    if(numbers.empty()){
+        auto segment = openSegment(0, true);
+        if(!segment){
+            return false;
+        }
+        active_ = segment.get();
+        segments_.push_back(std::move(segment));
+        return true;
+    }
+
+    // Index: newest usable checkpoint, then replay only what came after it.
+    std::vector<uint64_t> checkpoints = listNumbered(directory_, ".idx");
+    std::optional<uint64_t> checkpoint;
+    for(auto it = checkpoints.rbegin(); it != checkpoints.rend() && !checkpoint; ++it){
+        if(*it <= numbers.back() && loadCheckpoint(*it)){
+            checkpoint = *it;
+        }
+    }
+    recovery_.fromCheckpoint = checkpoint.has_value();
+    size_t replayFrom = checkpoint ? std::upper_bound(numbers.begin(), numbers.end(), *checkpoint) - numbers.begin() : 0;
+
+    // Chain: everything up to the newest segment closed by a final block
+    // entry is sealed; sealing resumes after it.
+    size_t sealFrom = 0;
+    for(size_t i = numbers.size(); i-- > 0 && !sealFrom;){
+        std::vector<BlockEntry> entries = readBlocks(segmentPath(numbers[i], ".blk"));
+        if(!entries.empty() && entries.back().flags & kBlockFinal){
+            head_ = entries.back().hash;
+            blocks_ = entries.back().block;
+            sealFrom = i + 1;
+        }
+    }
+
+    for(size_t i = std::min(replayFrom, sealFrom); i < numbers.size(); ++i){
+        auto segment = openSegment(numbers[i], false);
+        if(!segment){
+            return false;
+        }
+        std::vector<BlockEntry> entries = readBlocks(segmentPath(numbers[i], ".blk"));
+        uint64_t sealed = entries.empty() ? kSegmentHeader : entries.back().end;
+        bool replay = i >= replayFrom;
+        uint64_t offset = kSegmentHeader;
+        for(;;){
+            uint64_t size = recordAt(segment->base, segment->capacity, offset);
+            if(!size && offset < sealed){
+                // A bad record inside a sealed block is damage, not a torn
+                // append: skip the block and leave it for verify() to report.
+                offset = std::find_if(entries.begin(), entries.end(), [&](const BlockEntry& e){ return e.end > offset; })->end;
+                continue;
+            }
+            if(!size){
+                break;
+            }
+            if(replay && segment->base[offset + 4] == kRecordRoute){
+                index_.insert(routeKey(segment->base + offset));
+                ++recovery_.recordsReplayed;
+            }
+            offset += size;
+        }
+        segment->end.store(offset, std::memory_order_relaxed);
+        ++recovery_.segmentsScanned;
+        if(i < sealFrom){
+            continue;
+        }
+
+        segment->blockEntries = entries.size();
+        if(ftruncate(segment->blockFd, static_cast<off_t>(entries.size() * kBlockEntry)) != 0){
+            return false;
+        }
+        if(!entries.empty()){
+            head_ = entries.back().hash;
+            blocks_ = entries.back().block + 1;
+            segment->sealedEnd = entries.back().end;
+        }
+        segment->closed.store(i + 1 < numbers.size(), std::memory_order_relaxed);
+        segments_.push_back(std::move(segment));
+    }
+
+    if(segments_.empty()){
+        auto segment = openSegment(numbers.back() + 1, true);
+        if(!segment){
+            return false;
+        }
+        segments_.push_back(std::move(segment));
+    }
+    active_ = segments_.back().get();
+
+    // Writeback may have persisted pages past a torn record; zero them so a
+    // later append cannot make them look like part of the log again.
+    uint64_t tail = active_->end.load(std::memory_order_relaxed);
+    uint64_t clean = std::min(active_->capacity, pageAlignDown(tail + static_cast<uint64_t>(sysconf(_SC_PAGESIZE)) - 1));
+    memset(active_->base + tail, 0, clean - tail);
+    if(clean < active_->capacity
+       && fallocate(active_->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, static_cast<off_t>(clean),
+                    static_cast<off_t>(active_->capacity - clean)) != 0){
+        memset(active_->base + clean, 0, active_->capacity - clean);
+    }
+    return true;
+}
+
+bool RouteLogChain::writeCheckpoint(uint64_t number) const{
+    std::vector<uint8_t> image = index_.serialize();
+    uint8_t header[kCheckpointHeader] = {};
+    storeBE<uint32_t>(header, kCheckpointMagic);
+    storeBE<uint64_t>(header + 8, number);
+    storeBE<uint64_t>(header + 16, checksum(image));
+
+    // Not synced: a checkpoint lost in a crash only means replaying one more
+    // segment on the next open.
+    std::string path = segmentPath(number, ".idx");
+    std::string temp = path + ".tmp";
+    int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(fd < 0){
+        return false;
+    }
+    bool ok = writeAll(fd, header, sizeof(header)) && writeAll(fd, image.data(), image.size());
+    close(fd);
+    return ok && rename(temp.c_str(), path.c_str()) == 0;
+}
+
+bool RouteLogChain::loadCheckpoint(uint64_t number){
+    std::vector<uint8_t> bytes;
+    if(!readFile(segmentPath(number, ".idx"), bytes) || bytes.size() < kCheckpointHeader
+       || loadBE<uint32_t>(bytes.data()) != kCheckpointMagic || loadBE<uint64_t>(bytes.data() + 8) != number){
+        return false;
+    }
+    std::span<const uint8_t> image(bytes.data() + kCheckpointHeader, bytes.size() - kCheckpointHeader);
+    if(loadBE<uint64_t>(bytes.data() + 16) != checksum(image) || !index_.restore(image)){
+        index_ = ReplayIndex(config_.index);
+        return false;
+    }
+    return true;
+}
+
+bool RouteLogChain::rotate(){
+    // The checkpoint covers every record up to the end of this segment.
+    uint64_t number = active_->number;
+    if(!writeCheckpoint(number)){
+        return false;
+    }
+    auto next = openSegment(number + 1, true);
+    if(!next){
+        return false;
+    }
+    Segment* previous = active_;
+    {
+        std::lock_guard<std::mutex> lock(segmentsMutex_);
+        segments_.push_back(std::move(next));
+        active_ = segments_.back().get();
+    }
+    previous->closed.store(true, std::memory_order_release);
+
+    if(number >= 2){
+        unlink(segmentPath(number - 2, ".idx").c_str());
+    }
+    return true;
+}
+
+LogResult RouteLogChain::log(const RouteRecord& record){
+    if(record.hopCount > kMaxRouteHops){
+        return LogResult::Invalid;
+    }
+    if(!active_){
+        return LogResult::Failed;
+    }
+    uint32_t body = static_cast<uint32_t>(kRouteFixed + 4 * record.hopCount);
+    uint64_t size = kRecordFrame + body;
+    uint64_t tail = active_->end.load(std::memory_order_relaxed);
+    if(size > active_->capacity - tail){
+        if(!rotate()){
+            return LogResult::Failed;
+        }
+        tail = active_->end.load(std::memory_order_relaxed);
+        if(size > active_->capacity - tail){
+            return LogResult::Failed;
+        }
+    }
+    if(!index_.insert(replayKey(record))){
+        return LogResult::Replay;
+    }
+
+    uint8_t* out = active_->base + tail;
+    storeBE<uint32_t>(out, body);
+    out[4] = kRecordRoute;
+    uint8_t* fields = out + 5;
+    storeBE<uint32_t>(fields, record.senderID);
+    storeBE<uint32_t>(fields + 4, record.receiverID);
+    storeBE<uint32_t>(fields + 8, record.transferId);
+    storeBE<uint32_t>(fields + 12, record.seq);
+    storeBE<uint64_t>(fields + 16, record.timestamp);
+    fields[24] = record.hopCount;
+    storeBE<uint32_t>(fields + kRouteFixed, std::span<const uint32_t>(record.hops, record.hopCount));
+    storeBE<uint32_t>(out + 5 + body, fnv1a(out, 5 + body));
+
+    active_->end.store(tail + size, std::memory_order_release);
+    return LogResult::Logged;
+}
+
+bool RouteLogChain::appendBlock(Segment& segment, uint64_t start, uint64_t end, uint32_t records, bool final){
+    uint8_t entry[kBlockEntry];
+    encodeBlock(BlockEntry{blocks_, start, end, records, final ? kBlockFinal : 0, head_}, entry);
+    if(pwrite(segment.blockFd, entry, sizeof(entry), static_cast<off_t>(segment.blockEntries * kBlockEntry))
+       != static_cast<ssize_t>(sizeof(entry))){
+        return false;
+    }
+    if(config_.syncOnSeal && fdatasync(segment.blockFd) != 0){
+        return false;
+    }
+    ++segment.blockEntries;
+    return true;
+}
+
+bool RouteLogChain::sealBlock(Segment& segment, uint64_t end){
+    // Records below end were written (or validated) by this process, so
+    // their lengths can be trusted.
+    uint64_t start = segment.sealedEnd;
+    uint64_t offset = start;
+    uint32_t records = 0;
+    for(; offset < end && records < config_.blockRecords; ++records){
+        offset += kRecordFrame + loadBE<uint32_t>(segment.base + offset);
+    }
+
+    Sha256 sha;
+    sha.update(head_);
+    sha.update({segment.base + start, offset - start});
+    Sha256Digest previous = head_;
+    head_ = sha.finish();
+
+    uint64_t synced = pageAlignDown(start);
+    if((config_.syncOnSeal && msync(segment.base + synced, offset - synced, MS_SYNC) != 0)
+       || !appendBlock(segment, start, offset, records, false)){
+        head_ = previous;
+        return false;
+    }
+    segment.sealedEnd = offset;
+    ++blocks_;
+    return true;
+}
+
+size_t RouteLogChain::sealPending(){
+    std::lock_guard<std::mutex> sealLock(sealMutex_);
+    size_t sealed = 0;
+    for(;;){
+        Segment* segment;
+        {
+            std::lock_guard<std::mutex> lock(segmentsMutex_);
+            if(segments_.empty()){
+                return sealed;
+            }
+            segment = segments_.front().get();
+        }
+        // closed first: once it is set, end is final.
+        bool closed = segment->closed.load(std::memory_order_acquire);
+        uint64_t end = segment->end.load(std::memory_order_acquire);
+        while(segment->sealedEnd < end){
+            if(!sealBlock(*segment, end)){
+                return sealed;
+            }
+            ++sealed;
+        }
+        if(!closed || !appendBlock(*segment, end, end, 0, true)){
+            return sealed;
+        }
+        std::lock_guard<std::mutex> lock(segmentsMutex_);
+        segments_.pop_front();
+    }
+}
+
+Sha256Digest RouteLogChain::head() const{
+    std::lock_guard<std::mutex> lock(sealMutex_);
+    return head_;
+}
+
+uint64_t RouteLogChain::blocks() const{
+    std::lock_guard<std::mutex> lock(sealMutex_);
+    return blocks_;
+}
+
+bool RouteLogChain::verify() const{
+    std::lock_guard<std::mutex> lock(sealMutex_);
+    Sha256Digest head{};
+    uint64_t block = 0;
+    for(uint64_t number : listNumbered(directory_, ".seg")){
+        std::vector<uint8_t> bytes;
+        if(!readFile(segmentPath(number, ".seg"), bytes)){
+            return false;
+        }
+        uint64_t offset = kSegmentHeader;
+        for(const BlockEntry& entry : readBlocks(segmentPath(number, ".blk"))){
+            if(entry.block != block || entry.start != offset || entry.end < entry.start || entry.end > bytes.size()){
+                return false;
+            }
+            if(entry.flags & kBlockFinal){
+                if(entry.hash != head){
+                    return false;
+                }
+                break;
+            }
+            Sha256 sha;
+            sha.update(head);
+            sha.update({bytes.data() + entry.start, entry.end - entry.start});
+            head = sha.finish();
+            if(head != entry.hash){
+                return false;
+            }
+            offset = entry.end;
+            ++block;
+        }
+    }
+    return block == blocks_ && head == head_;
+}
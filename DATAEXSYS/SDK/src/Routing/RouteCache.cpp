@@ -0,0 +1,217 @@
+#include "Routing/RouteCache.h"
+#include "Trust/TrustDiary.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace {
+
+// Fixed-point cost of one unit of a weight.
+constexpr double kCostScale = 1024.0;
+
+uint32_t fixedCost(double weight, double probability){
+    return static_cast<uint32_t>(std::lround(kCostScale * weight * -std::log(probability)));
+}
+
+}
+
+RouteCache::RouteCache(RouteGraph graph, uint32_t source, const RouteWeights& weights)
+    : graph_(std::move(graph)),
+      source_(source),
+      hopCost_(static_cast<uint32_t>(std::lround(kCostScale * weights.hop))),
+      trustLevel_(graph_.nodes(), kLevels),
+      dist_(graph_.nodes(), kUnreachable),
+      parent_(graph_.nodes(), kNoNode),
+      parentEdge_(graph_.nodes(), kNoNode){
+    // Level 0 trust is costed like level 1: an untrusted node is still a
+    // destination. Level 0 quality is a link that is down.
+    for(uint32_t l = 1; l <= kLevels; ++l){
+        trustCost_[l] = fixedCost(weights.trust, static_cast<double>(l) / kLevels);
+        qualityCost_[l] = fixedCost(weights.quality, static_cast<double>(l) / kLevels);
+    }
+    trustCost_[0] = trustCost_[1];
+    qualityCost_[0] = kDown;
+
+    for(uint32_t edge = 0; edge < graph_.edges(); ++edge){
+        graph_.setWeight(edge, weightOf(edge, graph_.arc(edge).head));
+    }
+    recompute();
+}
+
+uint8_t RouteCache::level(double value){
+    return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0, 1.0) * kLevels));
+}
+
+uint32_t RouteCache::weightOf(uint32_t edge, uint32_t head) const{
+    uint32_t quality = qualityCost_[level(graph_.quality(edge))];
+    return quality == kDown ? kDown : hopCost_ + trustCost_[trustLevel_[head]] + quality;
+}
+
+void RouteCache::offer(uint32_t node, uint64_t dist, uint32_t parent, uint32_t edge){
+    if(dist < dist_[node]){
+        dist_[node] = dist;
+        parent_[node] = parent;
+        parentEdge_[node] = edge;
+        heap_.push_back(Pending{dist, node});
+        std::push_heap(heap_.begin(), heap_.end(), std::greater<>{});
+    }
+}
+
+void RouteCache::settle(){
+    while(!heap_.empty()){
+        std::pop_heap(heap_.begin(), heap_.end(), std::greater<>{});
+        Pending next = heap_.back();
+        heap_.pop_back();
+        if(next.dist != dist_[next.node]){
+            continue;   // superseded by a later offer
+        }
+        ++stats_.settled;
+
+        uint32_t edge = graph_.firstEdge(next.node);
+        for(const RouteGraph::Arc& arc : graph_.out(next.node)){
+            if(arc.weight != kDown){
+                offer(arc.head, next.dist + arc.weight, next.node, edge);
+            }
+            ++edge;
+        }
+    }
+}
+
+void RouteCache::recompute(){
+    std::fill(dist_.begin(), dist_.end(), kUnreachable);
+    std::fill(parent_.begin(), parent_.end(), kNoNode);
+    std::fill(parentEdge_.begin(), parentEdge_.end(), kNoNode);
+    stats_ = {};
+    heap_.clear();
+    offer(source_, 0, kNoNode, kNoNode);
+    settle();
+}
+
+void RouteCache::invalidate(uint32_t root){
+    // scratch_ doubles as the BFS queue and the list of cut nodes.
+    size_t next = scratch_.size();
+    scratch_.push_back(root);
+    for(; next < scratch_.size(); ++next){
+        uint32_t node = scratch_[next];
+        dist_[node] = kUnreachable;
+        parent_[node] = kNoNode;
+        parentEdge_[node] = kNoNode;
+        uint32_t edge = graph_.firstEdge(node);
+        for(const RouteGraph::Arc& arc : graph_.out(node)){
+            if(parentEdge_[arc.head] == edge){
+                scratch_.push_back(arc.head);
+            }
+            ++edge;
+        }
+    }
+}
+
+void RouteCache::reweigh(std::span<const uint32_t> edges){
+    stats_ = {};
+    scratch_.clear();
+    changed_.clear();
+
+    // Dearer tree edges cut their subtree loose; every other change leaves
+    // the existing distances valid upper bounds.
+    for(uint32_t edge : edges){
+        uint32_t head = graph_.arc(edge).head;
+        uint32_t before = graph_.arc(edge).weight;
+        uint32_t after = weightOf(edge, head);
+        if(before == after){
+            continue;
+        }
+        graph_.setWeight(edge, after);
+        changed_.push_back(edge);
+        if(after > before && parentEdge_[head] == edge){
+            invalidate(head);
+        }
+    }
+    stats_.invalidated = static_cast<uint32_t>(scratch_.size());
+
+    // Re-seed the cut nodes from the intact tree around them, and let
+    // cheaper edges offer their heads a better route.
+    for(uint32_t node : scratch_){
+        for(const RouteGraph::InArc& in : graph_.in(node)){
+            uint32_t weight = graph_.arc(in.edge).weight;
+            if(dist_[in.tail] != kUnreachable && weight != kDown){
+                offer(node, dist_[in.tail] + weight, in.tail, in.edge);
+            }
+        }
+    }
+    for(uint32_t edge : changed_){
+        uint32_t tail = graph_.tail(edge);
+        uint32_t weight = graph_.arc(edge).weight;
+        if(dist_[tail] != kUnreachable && weight != kDown){
+            offer(graph_.arc(edge).head, dist_[tail] + weight, tail, edge);
+        }
+    }
+    settle();
+}
+
+void RouteCache::setTrust(uint32_t node, double trust){
+    uint8_t l = std::max<uint8_t>(1, level(trust));
+    if(node >= graph_.nodes() || trustLevel_[node] == l){
+        return;
+    }
+    trustLevel_[node] = l;
+    trustEdges_.clear();
+    for(const RouteGraph::InArc& in : graph_.in(node)){
+        trustEdges_.push_back(in.edge);
+    }
+    reweigh(trustEdges_);
+}
+
+void RouteCache::syncTrust(const TrustDiary& diary){
+    trustEdges_.clear();
+    uint32_t nodes = static_cast<uint32_t>(std::min<size_t>(graph_.nodes(), diary.capacity()));
+    for(uint32_t node = 0; node < nodes; ++node){
+        uint8_t l = std::max<uint8_t>(1, level(diary.trust(node)));
+        if(trustLevel_[node] != l){
+            trustLevel_[node] = l;
+            for(const RouteGraph::InArc& in : graph_.in(node)){
+                trustEdges_.push_back(in.edge);
+            }
+        }
+    }
+    if(!trustEdges_.empty()){
+        reweigh(trustEdges_);
+    }
+}
+
+void RouteCache::setLinkQuality(uint32_t from, uint32_t to, double quality){
+    uint32_t edge = graph_.find(from, to);
+    if(edge == graph_.edges()){
+        return;
+    }
+    graph_.setQuality(edge, static_cast<float>(quality));
+    reweigh({&edge, 1});
+}
+
+uint32_t RouteCache::nextHop(uint32_t destination) const{
+    if(destination == source_ || !reachable(destination)){
+        return kNoNode;
+    }
+    uint32_t node = destination;
+    while(parent_[node] != source_){
+        node = parent_[node];
+    }
+    return node;
+}
+
+size_t RouteCache::route(uint32_t destination, std::span<uint32_t> out) const{
+    if(destination == source_ || !reachable(destination)){
+        return 0;
+    }
+    size_t hops = 0;
+    for(uint32_t node = destination; node != source_; node = parent_[node]){
+        ++hops;
+    }
+    if(hops > out.size()){
+        return 0;
+    }
+    size_t i = hops;
+    for(uint32_t node = destination; node != source_; node = parent_[node]){
+        out[--i] = node;
+    }
+    return hops;
+}
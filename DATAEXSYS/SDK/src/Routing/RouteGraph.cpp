@@ -0,0 +1,59 @@
+#include "Routing/RouteGraph.h"
+#include <algorithm>
+
+namespace {
+
+bool inRange(const Link& link, uint32_t nodes){
+    return link.from < nodes && link.to < nodes;
+}
+
+}
+
+RouteGraph::RouteGraph(uint32_t nodes, std::span<const Link> links)
+    : offsets_(size_t{nodes} + 1, 0), inOffsets_(size_t{nodes} + 1, 0){
+    size_t kept = 0;
+    for(const Link& link : links){
+        if(inRange(link, nodes)){
+            ++offsets_[link.from + 1];
+            ++inOffsets_[link.to + 1];
+            ++kept;
+        }
+    }
+    arcs_.resize(kept);
+    quality_.resize(kept);
+    inArcs_.resize(kept);
+    for(uint32_t node = 0; node < nodes; ++node){
+        offsets_[node + 1] += offsets_[node];
+        inOffsets_[node + 1] += inOffsets_[node];
+    }
+
+    // Counting sort keeps the input order within each node, so the layout
+    // (and every tie broken by it) is deterministic.
+    std::vector<uint32_t> next(offsets_.begin(), offsets_.end() - 1);
+    std::vector<uint32_t> nextIn(inOffsets_.begin(), inOffsets_.end() - 1);
+    for(const Link& link : links){
+        if(!inRange(link, nodes)){
+            continue;
+        }
+        uint32_t edge = next[link.from]++;
+        arcs_[edge] = Arc{link.to, 0};
+        quality_[edge] = link.quality;
+        inArcs_[nextIn[link.to]++] = InArc{link.from, edge};
+    }
+}
+
+uint32_t RouteGraph::tail(uint32_t edge) const{
+    return static_cast<uint32_t>(std::upper_bound(offsets_.begin(), offsets_.end(), edge) - offsets_.begin() - 1);
+}
+
+uint32_t RouteGraph::find(uint32_t from, uint32_t to) const{
+    if(from >= nodes()){
+        return edges();
+    }
+    for(uint32_t edge = offsets_[from]; edge < offsets_[from + 1]; ++edge){
+        if(arcs_[edge].head == to){
+            return edge;
+        }
+    }
+    return edges();
+}
@@ -0,0 +1,57 @@
+#include "Routing/TopologyGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+Topology generateTopology(const TopologyConfig& config){
+    SplitMix64 rng{config.seed};
+    Topology topology;
+    topology.nodes = config.nodes;
+
+    std::vector<double> x(config.nodes), y(config.nodes);
+    for(uint32_t node = 0; node < config.nodes; ++node){
+        x[node] = rng.unit();
+        y[node] = rng.unit();
+        // One node in ten drops most of what it should forward.
+        topology.trust.push_back(rng.next() % 10 ? static_cast<float>(0.8 + 0.2 * rng.unit())
+                                                 : static_cast<float>(0.1 + 0.3 * rng.unit()));
+    }
+
+    // Expected degree of a node is nodes * pi * range^2.
+    double range = std::sqrt(config.averageDegree / (std::numbers::pi * config.nodes));
+    uint32_t cells = std::max<uint32_t>(1, static_cast<uint32_t>(1.0 / range));
+    auto cellOf = [&](double v){ return std::min(cells - 1, static_cast<uint32_t>(v * cells)); };
+
+    // Bucket nodes by grid cell so only neighboring cells are compared.
+    std::vector<uint32_t> cellStart(cells * cells + 1, 0), byCell(config.nodes);
+    for(uint32_t node = 0; node < config.nodes; ++node){
+        ++cellStart[cellOf(y[node]) * cells + cellOf(x[node]) + 1];
+    }
+    for(uint32_t cell = 0; cell < cells * cells; ++cell){
+        cellStart[cell + 1] += cellStart[cell];
+    }
+    std::vector<uint32_t> fill(cellStart.begin(), cellStart.end() - 1);
+    for(uint32_t node = 0; node < config.nodes; ++node){
+        byCell[fill[cellOf(y[node]) * cells + cellOf(x[node])]++] = node;
+    }
+
+    for(uint32_t a = 0; a < config.nodes; ++a){
+        uint32_t cx = cellOf(x[a]), cy = cellOf(y[a]);
+        for(uint32_t ny = cy ? cy - 1 : 0; ny <= std::min(cells - 1, cy + 1); ++ny){
+            for(uint32_t nx = cx ? cx - 1 : 0; nx <= std::min(cells - 1, cx + 1); ++nx){
+                uint32_t cell = ny * cells + nx;
+                for(uint32_t i = cellStart[cell]; i < cellStart[cell + 1]; ++i){
+                    uint32_t b = byCell[i];
+                    double d = std::hypot(x[a] - x[b], y[a] - y[b]) / range;
+                    if(b <= a || d >= 1.0){
+                        continue;
+                    }
+                    double quality = 1.0 - 0.8 * d * d;
+                    topology.links.push_back(Link{a, b, static_cast<float>(quality * (0.9 + 0.1 * rng.unit()))});
+                    topology.links.push_back(Link{b, a, static_cast<float>(quality * (0.9 + 0.1 * rng.unit()))});
+                }
+            }
+        }
+    }
+    return topology;
+}
@@ -0,0 +1,218 @@
+#include "Trust/TrustDiary.h"
+#include "Helper/WireCodec.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr unsigned kEpochBits = 20;
+constexpr unsigned kCountBits = 22;
+constexpr unsigned kFracBits = 8;
+constexpr uint32_t kEpochMask = (1u << kEpochBits) - 1;
+constexpr uint64_t kCountMax = (uint64_t{1} << kCountBits) - 1;
+constexpr double kCountScale = 1u << kFracBits;
+
+// Longest decay table kept. advanceEpoch() sweeps fully decayed words once
+// per kSweepEpochs, so no word is read older than the table plus one sweep
+// plus one jump below kMaxDecayEpochs, inside the half of the epoch ring
+// read as the past.
+constexpr size_t kMaxDecayEpochs = 3 << 16;
+constexpr size_t kSweepEpochs = 1 << 16;
+constexpr uint32_t kEpochHalf = 1u << (kEpochBits - 1);
+static_assert(2 * kMaxDecayEpochs + kSweepEpochs < kEpochHalf);
+
+constexpr uint32_t kSnapshotMagic = 0x42544431;   // "BTD1"
+constexpr size_t kSnapshotHeader = 12;
+constexpr size_t kSnapshotStride = 512;
+
+constexpr uint64_t pack(uint32_t epoch, uint64_t alpha, uint64_t beta){
+    return (uint64_t{epoch & kEpochMask} << (2 * kCountBits)) | (alpha << kCountBits) | beta;
+}
+
+constexpr uint32_t epochOf(uint64_t word){ return static_cast<uint32_t>(word >> (2 * kCountBits)); }
+constexpr uint32_t alphaOf(uint64_t word){ return static_cast<uint32_t>((word >> kCountBits) & kCountMax); }
+constexpr uint32_t betaOf(uint64_t word){ return static_cast<uint32_t>(word & kCountMax); }
+
+// Written in a later epoch than now, e.g. by a writer that loaded the epoch
+// after this reader did.
+constexpr bool isAhead(uint64_t word, uint32_t now){
+    return ((now - epochOf(word)) & kEpochMask) >= kEpochHalf;
+}
+
+constexpr uint32_t ageOf(uint64_t word, uint32_t now){
+    return isAhead(word, now) ? 0 : (now - epochOf(word)) & kEpochMask;
+}
+
+}
+
+TrustDiary::TrustDiary(size_t capacity, const TrustConfig& config)
+    : capacity_(capacity),
+      config_(config),
+      evidence_(std::make_unique<std::atomic<uint64_t>[]>(capacity)){
+    for(size_t i = 0; i < capacity_; ++i){
+        evidence_[i].store(0, std::memory_order_relaxed);
+    }
+    // Q16 multipliers for every age at which evidence can still be non-zero.
+    // A decay so slow that its multiplier is still above zero at the end of
+    // the table would drop evidence abruptly there, so it is clamped to the
+    // slowest one the table covers.
+    if(config_.decayPerEpoch < 1.0){
+        double slowest = std::pow(0.5 / 65536.0, 1.0 / static_cast<double>(kMaxDecayEpochs));
+        config_.decayPerEpoch = std::min(config_.decayPerEpoch, slowest);
+        for(size_t age = 0; age < kMaxDecayEpochs; ++age){
+            double factor = std::pow(config_.decayPerEpoch, static_cast<double>(age));
+            uint32_t q16 = static_cast<uint32_t>(std::lround(factor * 65536.0));
+            if(factor * static_cast<double>(kCountMax) < 1.0 || q16 == 0){
+                break;
+            }
+            decay_.push_back(q16);
+        }
+    }
+}
+
+TrustDiary::Evidence TrustDiary::decayed(uint64_t word, uint32_t now) const{
+    Evidence e{alphaOf(word), betaOf(word)};
+    if(decay_.empty()){
+        return e;
+    }
+    uint32_t age = ageOf(word, now);
+    if(age >= decay_.size()){
+        return Evidence{0, 0};
+    }
+    uint64_t factor = decay_[age];
+    return Evidence{static_cast<uint32_t>((e.alpha * factor) >> 16), static_cast<uint32_t>((e.beta * factor) >> 16)};
+}
+
+TrustCounts TrustDiary::counts(uint32_t node) const{
+    if(node >= capacity_){
+        return TrustCounts{config_.priorAlpha, config_.priorBeta};
+    }
+    Evidence e = decayed(evidence_[node].load(std::memory_order_relaxed), epoch());
+    return TrustCounts{config_.priorAlpha + e.alpha / kCountScale, config_.priorBeta + e.beta / kCountScale};
+}
+
+double TrustDiary::trust(uint32_t node) const{
+    TrustCounts c = counts(node);
+    return c.alpha / (c.alpha + c.beta);
+}
+
+void TrustDiary::record(uint32_t node, bool forwarded){
+    TrustOutcome outcome{node, forwarded ? uint16_t{1} : uint16_t{0}, forwarded ? uint16_t{0} : uint16_t{1}};
+    applyBatch({&outcome, 1});
+}
+
+void TrustDiary::applyBatch(std::span<const TrustOutcome> outcomes){
+    uint32_t now = epoch() & kEpochMask;
+    size_t i = 0;
+    while(i < outcomes.size()){
+        uint32_t node = outcomes[i].node;
+        uint64_t forwarded = 0;
+        uint64_t dropped = 0;
+        for(; i < outcomes.size() && outcomes[i].node == node; ++i){
+            forwarded += outcomes[i].forwarded;
+            dropped += outcomes[i].dropped;
+        }
+        if(node >= capacity_){
+            continue;
+        }
+
+        std::atomic<uint64_t>& cell = evidence_[node];
+        uint64_t word = cell.load(std::memory_order_relaxed);
+        for(;;){
+            Evidence e = decayed(word, now);
+            uint64_t alpha = e.alpha + (forwarded << kFracBits);
+            uint64_t beta = e.beta + (dropped << kFracBits);
+            // Saturating by halving both sides keeps the posterior mean.
+            while(alpha > kCountMax || beta > kCountMax){
+                alpha >>= 1;
+                beta >>= 1;
+            }
+            // Never move a word back to an older epoch than it already has.
+            uint32_t stamp = isAhead(word, now) ? epochOf(word) : now;
+            if(cell.compare_exchange_weak(word, pack(stamp, alpha, beta), std::memory_order_relaxed)){
+                break;
+            }
+        }
+    }
+}
+
+void TrustDiary::advanceEpoch(uint32_t by){
+    uint32_t before = epoch_.fetch_add(by, std::memory_order_relaxed);
+    uint32_t now = before + by;
+    if(decay_.empty()){
+        return;
+    }
+    if(by >= kMaxDecayEpochs){
+        // Everything from before the jump has fully decayed, but its stamp
+        // may alias any age on the ring, so it all goes.
+        expire(now, true);
+    }else if(before / kSweepEpochs != now / kSweepEpochs){
+        expire(now, false);
+    }
+}
+
+void TrustDiary::expire(uint32_t now, bool all){
+    now &= kEpochMask;
+    for(size_t i = 0; i < capacity_; ++i){
+        uint64_t word = evidence_[i].load(std::memory_order_relaxed);
+        // A zero word carries no evidence at any age. Outside a jump the CAS
+        // loses to any writer that got in first, whose word is fresh.
+        while(word != 0){
+            bool stale = all || ageOf(word, now) >= decay_.size();
+            if(!stale || evidence_[i].compare_exchange_weak(word, 0, std::memory_order_relaxed)){
+                break;
+            }
+        }
+    }
+}
+
+size_t TrustDiary::snapshotSize() const{
+    return kSnapshotHeader + capacity_ * sizeof(uint64_t);
+}
+
+void TrustDiary::snapshot(std::span<uint8_t> out) const{
+    uint8_t* ptr = out.data();
+    storeBE<uint32_t>(ptr, kSnapshotMagic);
+    storeBE<uint32_t>(ptr + 4, epoch());
+    storeBE<uint32_t>(ptr + 8, static_cast<uint32_t>(capacity_));
+    ptr += kSnapshotHeader;
+
+    uint64_t words[kSnapshotStride];
+    for(size_t base = 0; base < capacity_; base += kSnapshotStride){
+        size_t n = std::min(kSnapshotStride, capacity_ - base);
+        for(size_t i = 0; i < n; ++i){
+            words[i] = evidence_[base + i].load(std::memory_order_relaxed);
+        }
+        storeBE<uint64_t>(ptr, std::span<const uint64_t>(words, n));
+        ptr += n * sizeof(uint64_t);
+    }
+}
+
+std::vector<uint8_t> TrustDiary::snapshot() const{
+    std::vector<uint8_t> image(snapshotSize());
+    snapshot(image);
+    return image;
+}
+
+bool TrustDiary::restore(std::span<const uint8_t> image){
+    if(image.size() != snapshotSize() || loadBE<uint32_t>(image.data()) != kSnapshotMagic
+       || loadBE<uint32_t>(image.data() + 8) != capacity_){
+        return false;
+    }
+    epoch_.store(loadBE<uint32_t>(image.data() + 4), std::memory_order_relaxed);
+
+    const uint8_t* ptr = image.data() + kSnapshotHeader;
+    uint64_t words[kSnapshotStride];
+    for(size_t base = 0; base < capacity_; base += kSnapshotStride){
+        size_t n = std::min(kSnapshotStride, capacity_ - base);
+        loadBE<uint64_t>(std::span<uint64_t>(words, n), ptr);
+        for(size_t i = 0; i < n; ++i){
+            evidence_[base + i].store(words[i], std::memory_order_relaxed);
+        }
+        ptr += n * sizeof(uint64_t);
+    }
+    if(!decay_.empty()){
+        expire(epoch(), false);
+    }
+    return true;
+}
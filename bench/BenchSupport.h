@@ -0,0 +1,42 @@
+#pragma once
+#include "Helper/Metrics.h"
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <memory>
+
+// Per-iteration latency for benchmarks: each timed() call lands in a
+// histogram, and report() publishes p50/p99 (ns) next to the throughput.
+class LatencyRecorder{
+public:
+    LatencyRecorder() : histogram_(std::make_unique<LogHistogram>()){}
+
+    template<typename Fn>
+    void timed(Fn&& fn){
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        histogram_->record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    void report(benchmark::State& state) const{
+        HistogramSnapshot snapshot;
+        histogram_->snapshotInto(snapshot);
+        state.counters["p50_ns"] = static_cast<double>(snapshot.percentile(0.50));
+        state.counters["p99_ns"] = static_cast<double>(snapshot.percentile(0.99));
+    }
+
+private:
+    std::unique_ptr<LogHistogram> histogram_;
+};
+
+// Publishes how much of the SDK's own instrumentation moved during a run.
+inline void reportMetricsSince(benchmark::State& state, const MetricsSnapshot& before){
+    MetricsSnapshot after = snapshotMetrics();
+    double iterations = static_cast<double>(state.iterations());
+    if(iterations == 0){
+        return;
+    }
+    state.counters["allocs/iter"] = (after[Counter::PoolAllocs] + after[Counter::HeapAllocs]
+                                     - before[Counter::PoolAllocs] - before[Counter::HeapAllocs]) / iterations;
+    state.counters["copied/iter"] = (after[Counter::BytesCopied] - before[Counter::BytesCopied]) / iterations;
+}
@@ -0,0 +1,45 @@
+#include "App/AppLayer.h"
+#include "Memory/BufferPool.h"
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <vector>
+
+static void BM_MallocFree(benchmark::State& state){
+    for(auto _ : state){
+        void* ptr = std::malloc(state.range(0));
+        benchmark::DoNotOptimize(ptr);
+        std::free(ptr);
+    }
+}
+
+static void BM_PoolAllocFree(benchmark::State& state){
+    BufferPool& pool = defaultBufferPool();
+    for(auto _ : state){
+        BufferHandle buf = pool.alloc(state.range(0));
+        benchmark::DoNotOptimize(buf.data());
+    }
+}
+
+// Steady-state send: the chunk list comes from a slab, not the heap.
+static void BM_SendDataChunks(benchmark::State& state){
+    std::vector<uint8_t> payload(state.range(0), 0x5A);
+    File file{"capture", "pcap", payload.size(), payload.data()};
+    uint32_t chunks = sendData(file, 1, 2)->count;
+    BufferPoolStats before = defaultBufferPool().stats();
+    for(auto _ : state){
+        ChunkList list = sendData(file, 1, 2);
+        benchmark::DoNotOptimize(list->count);
+    }
+    BufferPoolStats after = defaultBufferPool().stats();
+    double hits = static_cast<double>(after.hits - before.hits);
+    double served = hits + static_cast<double>(after.misses - before.misses);
+    state.counters["hit_rate"] = served ? hits / served : 0.0;
+    state.counters["high_water"] = static_cast<double>(after.highWater);
+    // One descriptor per iteration, whatever the payload size: count chunks.
+    state.SetItemsProcessed(state.iterations() * chunks);
+}
+
+BENCHMARK(BM_MallocFree)->Arg(256)->Arg(4096);
+BENCHMARK(BM_PoolAllocFree)->Arg(256)->Arg(4096);
+BENCHMARK(BM_SendDataChunks)->Arg(64 << 10)->Arg(1 << 20);
+BENCHMARK(BM_PoolAllocFree)->Arg(256)->Threads(4);
@@ -0,0 +1,63 @@
+#include "App/AppLayer.h"
+#include "App/Chunking/Chunker.h"
+#include "App/Chunking/Reassembler.h"
+#include "BenchSupport.h"
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <numeric>
+#include <random>
+#include <vector>
+
+static void BM_Chunk(benchmark::State& state){
+    std::vector<uint8_t> payload(state.range(0), 0x3C);
+    File file{"capture", "pcap", payload.size(), payload.data()};
+    Message batch[64];
+    uint32_t chunks = sendData(file, 1, 2)->count;
+    LatencyRecorder latency;
+    MetricsSnapshot before = snapshotMetrics();
+    for(auto _ : state){
+        latency.timed([&]{
+            ChunkList list = sendData(file, 1, 2);
+            for(uint32_t seq = 0; seq < list->count; seq += std::size(batch)){
+                size_t n = fillChunks(*list, seq, batch);
+                benchmark::DoNotOptimize(batch[n - 1].data);
+            }
+        });
+    }
+    latency.report(state);
+    reportMetricsSince(state, before);
+    // The payload is borrowed, not touched, so the rate is in chunks described.
+    state.SetItemsProcessed(state.iterations() * chunks);
+}
+
+// Chunk then reassemble into a second buffer; range(1) != 0 shuffles arrival.
+static void BM_Reassemble(benchmark::State& state){
+    std::vector<uint8_t> payload(state.range(0), 0x3C);
+    std::vector<uint8_t> received(payload.size());
+    File file{"capture", "pcap", payload.size(), payload.data()};
+    ChunkList list = sendData(file, 1, 2);
+
+    std::vector<uint32_t> order(list->count);
+    std::iota(order.begin(), order.end(), 0);
+    if(state.range(1)){
+        std::shuffle(order.begin(), order.end(), std::mt19937(7));
+    }
+
+    LatencyRecorder latency;
+    for(auto _ : state){
+        latency.timed([&]{
+            MemorySink sink(received);
+            Reassembler reassembler(chunkHeaderAt(*list, 0), sink);
+            for(uint32_t seq : order){
+                Message chunk = chunkAt(*list, seq);
+                reassembler.accept(chunkHeaderAt(*list, seq), {static_cast<const uint8_t*>(chunk.data), chunk.size});
+            }
+            benchmark::DoNotOptimize(reassembler.complete());
+        });
+    }
+    latency.report(state);
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_Chunk)->Arg(1 << 20)->Arg(64 << 20)->Arg(1 << 30);
+BENCHMARK(BM_Reassemble)->ArgsProduct({{1 << 20, 64 << 20, 1 << 30}, {0, 1}});
@@ -0,0 +1,49 @@
+#include "App/Adapters/FileToRaw.h"
+#include "BenchSupport.h"
+#include <benchmark/benchmark.h>
+#include <vector>
+
+static File makeFile(std::vector<uint8_t>& payload){
+    File file;
+    file.filename = "capture";
+    file.extension = "pcap";
+    file.size = payload.size();
+    file.data = payload.data();
+    return file;
+}
+
+// Baseline: full-file copy into a freshly allocated buffer.
+static void BM_ToRawCopy(benchmark::State& state){
+    std::vector<uint8_t> payload(state.range(0), 0xA5);
+    File file = makeFile(payload);
+    LatencyRecorder latency;
+    for(auto _ : state){
+        latency.timed([&]{
+            RawFile* raw = toRaw(file);
+            benchmark::DoNotOptimize(raw->content);
+            delete[] raw->content;
+            delete raw;
+        });
+    }
+    latency.report(state);
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+// Scatter-gather: header only, payload borrowed.
+static void BM_ToRawView(benchmark::State& state){
+    std::vector<uint8_t> payload(state.range(0), 0xA5);
+    File file = makeFile(payload);
+    RawHeaderBuffer header;
+    LatencyRecorder latency;
+    for(auto _ : state){
+        latency.timed([&]{
+            RawFileView view = toRawView(file, header);
+            benchmark::DoNotOptimize(view.iov());
+        });
+    }
+    latency.report(state);
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_ToRawCopy)->RangeMultiplier(16)->Range(4 << 10, 256 << 20);
+BENCHMARK(BM_ToRawView)->RangeMultiplier(16)->Range(4 << 10, 256 << 20);
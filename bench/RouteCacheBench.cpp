@@ -0,0 +1,105 @@
+#include "Routing/RouteCache.h"
+#include "Routing/TopologyGenerator.h"
+#include "BenchSupport.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+
+namespace {
+
+RouteCache makeCache(uint32_t nodes, Topology& topology){
+    topology = generateTopology(TopologyConfig{nodes, 8.0, 42});
+    RouteCache cache(RouteGraph(nodes, topology.links), 0);
+    for(uint32_t node = 0; node < nodes; ++node){
+        cache.setTrust(node, topology.trust[node]);
+    }
+    return cache;
+}
+
+}
+
+static void BM_TopologyGenerate(benchmark::State& state){
+    uint32_t nodes = static_cast<uint32_t>(state.range(0));
+    for(auto _ : state){
+        Topology topology = generateTopology(TopologyConfig{nodes, 8.0, 42});
+        benchmark::DoNotOptimize(topology.links.data());
+    }
+    state.SetItemsProcessed(state.iterations() * nodes);
+}
+
+// Source route expansion from the parent array.
+static void BM_RouteLookup(benchmark::State& state){
+    uint32_t nodes = static_cast<uint32_t>(state.range(0));
+    Topology topology;
+    RouteCache cache = makeCache(nodes, topology);
+    SplitMix64 rng{9};
+    uint32_t hops[256];
+    size_t total = 0;
+    for(auto _ : state){
+        size_t n = cache.route(static_cast<uint32_t>(rng.next() % nodes), hops);
+        benchmark::DoNotOptimize(hops);
+        total += n;
+    }
+    state.counters["hops"] = static_cast<double>(total) / static_cast<double>(state.iterations());
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Baseline: the whole tree from scratch.
+static void BM_RouteRecompute(benchmark::State& state){
+    uint32_t nodes = static_cast<uint32_t>(state.range(0));
+    Topology topology;
+    RouteCache cache = makeCache(nodes, topology);
+    LatencyRecorder latency;
+    for(auto _ : state){
+        latency.timed([&]{ cache.recompute(); });
+    }
+    latency.report(state);
+    state.counters["settled"] = cache.lastRepair().settled;
+}
+
+// Incremental repair after one node's trust moves; alternates between
+// losing and regaining trust so the tree does not drift.
+static void BM_RouteRepairTrust(benchmark::State& state){
+    uint32_t nodes = static_cast<uint32_t>(state.range(0));
+    Topology topology;
+    RouteCache cache = makeCache(nodes, topology);
+    SplitMix64 rng{11};
+    LatencyRecorder latency;
+    uint64_t settled = 0;
+    for(auto _ : state){
+        uint32_t node = static_cast<uint32_t>(rng.next() % nodes);
+        latency.timed([&]{ cache.setTrust(node, 0.2); });
+        settled += cache.lastRepair().settled;
+        state.PauseTiming();
+        cache.setTrust(node, topology.trust[node]);
+        state.ResumeTiming();
+    }
+    latency.report(state);
+    state.counters["settled"] = static_cast<double>(settled) / static_cast<double>(state.iterations());
+}
+
+// Incremental repair after a link fades or drops.
+static void BM_RouteRepairLink(benchmark::State& state){
+    uint32_t nodes = static_cast<uint32_t>(state.range(0));
+    Topology topology;
+    RouteCache cache = makeCache(nodes, topology);
+    SplitMix64 rng{13};
+    LatencyRecorder latency;
+    uint64_t settled = 0;
+    for(auto _ : state){
+        const Link& link = topology.links[rng.next() % topology.links.size()];
+        double quality = rng.next() % 4 ? 0.3 : 0.0;
+        latency.timed([&]{ cache.setLinkQuality(link.from, link.to, quality); });
+        settled += cache.lastRepair().settled;
+        state.PauseTiming();
+        cache.setLinkQuality(link.from, link.to, link.quality);
+        state.ResumeTiming();
+    }
+    latency.report(state);
+    state.counters["settled"] = static_cast<double>(settled) / static_cast<double>(state.iterations());
+}
+
+BENCHMARK(BM_TopologyGenerate)->Arg(1000)->Arg(3000)->Arg(10000);
+BENCHMARK(BM_RouteLookup)->Arg(1000)->Arg(3000)->Arg(10000);
+BENCHMARK(BM_RouteRecompute)->Arg(1000)->Arg(3000)->Arg(10000);
+BENCHMARK(BM_RouteRepairTrust)->Arg(1000)->Arg(3000)->Arg(10000);
+BENCHMARK(BM_RouteRepairLink)->Arg(1000)->Arg(3000)->Arg(10000);
@@ -0,0 +1,138 @@
+#include "Chain/RouteLogChain.h"
+#include "BenchSupport.h"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+namespace {
+
+// Page-cache numbers: block durability (syncOnSeal) measures the disk instead.
+RouteLogConfig benchConfig(){
+    RouteLogConfig config;
+    config.segmentBytes = 16 << 20;
+    config.syncOnSeal = false;
+    return config;
+}
+
+std::string freshDirectory(const char* name){
+    std::string path = std::string("/tmp/babe_routelog_") + name;
+    std::filesystem::remove_all(path);
+    return path;
+}
+
+// 64 flows of 3-hop routes, interleaved the way chunks of concurrent
+// transfers arrive.
+RouteRecord makeRecord(uint64_t i){
+    uint32_t flow = static_cast<uint32_t>(i % 64);
+    return RouteRecord{flow % 8, flow / 8, flow, static_cast<uint32_t>(i / 64), i, 3, {11, 12, 13}};
+}
+
+}
+
+// Receive path: replay check plus append, with or without a sealer thread
+// hashing behind it.
+static void BM_RouteLogAppend(benchmark::State& state){
+    std::string dir = freshDirectory("append");
+    {
+        RouteLogChain chain(dir, benchConfig());
+        std::atomic<bool> stop{false};
+        std::thread sealer;
+        if(state.range(0)){
+            sealer = std::thread([&]{
+                while(!stop.load(std::memory_order_relaxed)){
+                    if(!chain.sealPending()){
+                        std::this_thread::sleep_for(std::chrono::microseconds(100));
+                    }
+                }
+            });
+        }
+
+        LatencyRecorder latency;
+        uint64_t i = 0;
+        for(auto _ : state){
+            RouteRecord record = makeRecord(i++);
+            latency.timed([&]{ benchmark::DoNotOptimize(chain.log(record)); });
+        }
+        stop = true;
+        if(sealer.joinable()){
+            sealer.join();
+        }
+        latency.report(state);
+        state.counters["blocks"] = static_cast<double>(chain.blocks());
+    }
+    state.SetItemsProcessed(state.iterations());
+    std::filesystem::remove_all(dir);
+}
+
+// Duplicate checks against a populated index: half hit the exact windows,
+// half are chunks that have not arrived yet.
+static void BM_RouteReplayCheck(benchmark::State& state){
+    ReplayIndex index;
+    uint64_t logged = static_cast<uint64_t>(state.range(0));
+    for(uint64_t i = 0; i < logged; ++i){
+        index.insert(replayKey(makeRecord(i)));
+    }
+    uint64_t i = logged - 32 * 1024;
+    for(auto _ : state){
+        benchmark::DoNotOptimize(index.contains(replayKey(makeRecord(i))));
+        i = i + 1 == logged + 32 * 1024 ? logged - 32 * 1024 : i + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Batched block hashing: records appended up front, then sealed in one call.
+static void BM_RouteSeal(benchmark::State& state){
+    std::string dir = freshDirectory("seal");
+    uint64_t records = static_cast<uint64_t>(state.range(0));
+    uint64_t next = 0;
+    {
+        RouteLogChain chain(dir, benchConfig());
+        for(auto _ : state){
+            state.PauseTiming();
+            for(uint64_t end = next + records; next < end; ++next){
+                chain.log(makeRecord(next));
+            }
+            state.ResumeTiming();
+            benchmark::DoNotOptimize(chain.sealPending());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * records);
+    std::filesystem::remove_all(dir);
+}
+
+// Startup over a chain of N full segments: checkpoint load plus a scan of
+// the active segment, independent of N.
+static void BM_RouteLogRecover(benchmark::State& state){
+    std::string dir = freshDirectory("recover");
+    RouteLogConfig config = benchConfig();
+    config.segmentBytes = 4 << 20;
+    {
+        RouteLogChain chain(dir, config);
+        uint64_t perSegment = config.segmentBytes / 46;
+        for(uint64_t i = 0; i < perSegment * state.range(0) + perSegment / 2; ++i){
+            chain.log(makeRecord(i));
+        }
+        chain.sealPending();
+    }
+
+    LatencyRecorder latency;
+    RouteLogRecovery recovery;
+    for(auto _ : state){
+        latency.timed([&]{
+            RouteLogChain chain(dir, config);
+            recovery = chain.recovery();
+        });
+    }
+    latency.report(state);
+    state.counters["replayed"] = static_cast<double>(recovery.recordsReplayed);
+    state.counters["scanned"] = recovery.segmentsScanned;
+    std::filesystem::remove_all(dir);
+}
+
+BENCHMARK(BM_RouteLogAppend)->Arg(0)->Arg(1)->UseRealTime();
+BENCHMARK(BM_RouteReplayCheck)->Arg(1 << 16)->Arg(1 << 22);
+BENCHMARK(BM_RouteSeal)->Arg(1024)->Arg(16 * 1024);
+BENCHMARK(BM_RouteLogRecover)->Arg(4)->Arg(32)->Unit(benchmark::kMillisecond);
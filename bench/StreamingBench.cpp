@@ -0,0 +1,99 @@
+#include "App/AppLayer.h"
+#include "App/Chunking/Chunker.h"
+#include "App/Chunking/Reassembler.h"
+#include "App/Streaming/FileSink.h"
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+std::string makeSourceFile(uint64_t bytes){
+    std::string path = "/tmp/babe_stream_" + std::to_string(bytes) + ".bin";
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    std::vector<uint8_t> block(1 << 20, 0x77);
+    for(uint64_t done = 0; done < bytes; done += block.size()){
+        if(::write(fd, block.data(), std::min<uint64_t>(block.size(), bytes - done)) < 0){
+            break;
+        }
+    }
+    close(fd);
+    return path;
+}
+
+// Peak RSS since the last reset, in MiB (VmHWM, reset through clear_refs).
+void resetPeakRss(){
+    if(FILE* f = fopen("/proc/self/clear_refs", "w")){
+        fputs("5", f);
+        fclose(f);
+    }
+}
+
+double peakRssMiB(){
+    double kb = 0;
+    if(FILE* f = fopen("/proc/self/status", "r")){
+        char line[256];
+        while(fgets(line, sizeof(line), f)){
+            if(sscanf(line, "VmHWM: %lf kB", &kb) == 1){
+                break;
+            }
+        }
+        fclose(f);
+    }
+    return kb / 1024;
+}
+
+}
+
+static void BM_StreamChunks(benchmark::State& state){
+    std::string path = makeSourceFile(state.range(0));
+    File meta{"capture", "pcap", 0, nullptr};
+    Message batch[64];
+    resetPeakRss();
+    for(auto _ : state){
+        MappedFileSource source(path.c_str(), 16 << 20);
+        ChunkStream stream = sendStream(meta, source, 1, 2);
+        uint64_t sum = 0;
+        while(size_t n = stream.next(batch)){
+            for(size_t i = 0; i < n; ++i){
+                sum += static_cast<const uint8_t*>(batch[i].data)[0];
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.counters["peak_rss_mib"] = peakRssMiB();
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+    unlink(path.c_str());
+}
+
+// Source file -> chunks -> reassembler -> FileSink on disk.
+static void BM_StreamToDisk(benchmark::State& state){
+    std::string path = makeSourceFile(state.range(0));
+    std::string out = path + ".out";
+    File meta{"capture", "pcap", 0, nullptr};
+    Message batch[64];
+    resetPeakRss();
+    for(auto _ : state){
+        MappedFileSource source(path.c_str(), 16 << 20);
+        ChunkStream stream = sendStream(meta, source, 1, 2);
+        FileSink sink(out.c_str());
+        Reassembler reassembler(chunkHeaderAt(stream.list(), 0), sink);
+        while(size_t n = stream.next(batch)){
+            for(size_t i = 0; i < n; ++i){
+                reassembler.accept(chunkHeaderAt(stream.list(), batch[i].SeqNum),
+                                   {static_cast<const uint8_t*>(batch[i].data), batch[i].size});
+            }
+        }
+        sink.finish(reassembler.payloadSize());
+    }
+    state.counters["peak_rss_mib"] = peakRssMiB();
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+    unlink(out.c_str());
+    unlink(path.c_str());
+}
+
+BENCHMARK(BM_StreamChunks)->Arg(64 << 20)->Arg(1 << 30)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_StreamToDisk)->Arg(64 << 20)->Arg(1 << 30)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,121 @@
+#include "App/AppLayer.h"
+#include "App/Chunking/Chunker.h"
+#include "App/Chunking/Reassembler.h"
+#include "Trans/BatchTransport.h"
+#include "BenchSupport.h"
+#include <arpa/inet.h>
+#include <benchmark/benchmark.h>
+#include <optional>
+#include <vector>
+
+namespace {
+
+sockaddr_in loopback(uint16_t port = 0){
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return addr;
+}
+
+// Drains whatever is queued into reassembler; returns chunks accepted.
+size_t drain(BatchTransport& rx, std::optional<Reassembler>& reassembler, ChunkSink& sink, int timeoutMs){
+    Datagram batch[64];
+    size_t accepted = 0;
+    while(size_t n = rx.receiveBatch(batch, timeoutMs)){
+        for(size_t i = 0; i < n; ++i){
+            if(!reassembler){
+                reassembler.emplace(batch[i].header, sink);
+            }
+            accepted += reassembler->accept(batch[i].header, batch[i].payload) == ChunkStatus::Accepted;
+        }
+        timeoutMs = 0;
+    }
+    return accepted;
+}
+
+}
+
+// Whole-file transfer over loopback UDP: the sender keeps inflightBatches
+// batches queued, the receiver drains them into a Reassembler, and any gaps
+// are resent from the seen-bitmap.
+static void BM_UdpLoopbackTransfer(benchmark::State& state){
+    TransportConfig config;
+    BatchTransport rx(config, loopback());
+    BatchTransport tx(config, loopback());
+    if(!rx.isOpen() || !tx.isOpen()){
+        state.SkipWithError("cannot open loopback UDP sockets");
+        return;
+    }
+    sockaddr_in to = rx.localAddress();
+
+    std::vector<uint8_t> payload(state.range(0), 0x42);
+    std::vector<uint8_t> received(payload.size());
+    File file{"capture", "pcap", payload.size(), payload.data()};
+    uint64_t resent = 0;
+    LatencyRecorder latency;
+    MetricsSnapshot before = snapshotMetrics();
+
+    for(auto _ : state){
+        latency.timed([&]{
+            ChunkList list = sendData(file, 1, 2);
+            MemorySink sink(received);
+            std::optional<Reassembler> reassembler;
+            uint32_t window = config.batchSize * config.inflightBatches;
+
+            for(uint32_t seq = 0; seq < list->count; seq += window){
+                tx.sendRange(*list, seq, std::min(window, list->count - seq), to);
+                drain(rx, reassembler, sink, 10);
+            }
+            while(!reassembler || !reassembler->complete()){
+                uint32_t missing = reassembler ? reassembler->nextMissing() : 0;
+                tx.sendRange(*list, missing, 1, to);
+                ++resent;
+                drain(rx, reassembler, sink, 10);
+            }
+        });
+    }
+    latency.report(state);
+    reportMetricsSince(state, before);
+    state.counters["resent"] = static_cast<double>(resent);
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+// Round trip of one batch through loopback.
+static void BM_UdpLoopbackBatch(benchmark::State& state){
+    TransportConfig config;
+    config.batchSize = static_cast<uint32_t>(state.range(0));
+    BatchTransport rx(config, loopback());
+    BatchTransport tx(config, loopback());
+    if(!rx.isOpen() || !tx.isOpen()){
+        state.SkipWithError("cannot open loopback UDP sockets");
+        return;
+    }
+    sockaddr_in to = rx.localAddress();
+
+    std::vector<uint8_t> payload(config.batchSize * (config.mtu - kChunkHeaderSize), 0x42);
+    File file{"capture", "pcap", payload.size(), payload.data()};
+    ChunkList list = sendData(file, 1, 2);
+    std::vector<Datagram> batch(config.batchSize);
+
+    LatencyRecorder latency;
+    for(auto _ : state){
+        latency.timed([&]{
+            tx.sendRange(*list, 0, config.batchSize, to);
+            size_t got = 0;
+            while(got < config.batchSize){
+                size_t n = rx.receiveBatch(batch, 100);
+                if(n == 0){
+                    break;
+                }
+                got += n;
+            }
+            benchmark::DoNotOptimize(got);
+        });
+    }
+    latency.report(state);
+    state.SetItemsProcessed(state.iterations() * config.batchSize);
+}
+
+BENCHMARK(BM_UdpLoopbackTransfer)->Arg(1 << 20)->Arg(64 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_UdpLoopbackBatch)->Arg(1)->Arg(8)->Arg(32)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,74 @@
+#include "Trust/TrustDiary.h"
+#include "BenchSupport.h"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Shared across benchmark threads so updates contend on one table.
+std::unique_ptr<TrustDiary> sharedDiary;
+
+std::vector<TrustOutcome> makeOutcomes(size_t count, uint32_t nodes, uint32_t seed){
+    std::mt19937 rng(seed);
+    std::vector<TrustOutcome> outcomes(count);
+    for(TrustOutcome& o : outcomes){
+        o.node = rng() % nodes;
+        bool forwarded = rng() % 10 != 0;
+        o.forwarded = forwarded;
+        o.dropped = !forwarded;
+    }
+    return outcomes;
+}
+
+}
+
+// Batched packet outcomes from every thread into one diary.
+static void BM_TrustApplyBatch(benchmark::State& state){
+    uint32_t nodes = static_cast<uint32_t>(state.range(0));
+    if(state.thread_index() == 0){
+        sharedDiary = std::make_unique<TrustDiary>(nodes);
+    }
+    std::vector<TrustOutcome> outcomes = makeOutcomes(256, nodes, 17 + state.thread_index());
+    for(auto _ : state){
+        sharedDiary->applyBatch(outcomes);
+        if(state.thread_index() == 0){
+            sharedDiary->advanceEpoch();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * outcomes.size());
+}
+
+// Routing-path lookups while the table is live.
+static void BM_TrustRead(benchmark::State& state){
+    uint32_t nodes = static_cast<uint32_t>(state.range(0));
+    TrustDiary diary(nodes);
+    diary.applyBatch(makeOutcomes(nodes * 4, nodes, 3));
+    uint32_t node = 0;
+    for(auto _ : state){
+        benchmark::DoNotOptimize(diary.trust(node));
+        node = node + 1 == nodes ? 0 : node + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_TrustSnapshotRestore(benchmark::State& state){
+    uint32_t nodes = static_cast<uint32_t>(state.range(0));
+    TrustDiary diary(nodes);
+    diary.applyBatch(makeOutcomes(nodes * 4, nodes, 5));
+    std::vector<uint8_t> image(diary.snapshotSize());
+    LatencyRecorder latency;
+    for(auto _ : state){
+        latency.timed([&]{
+            diary.snapshot(image);
+            benchmark::DoNotOptimize(diary.restore(image));
+        });
+    }
+    latency.report(state);
+    state.SetBytesProcessed(state.iterations() * image.size() * 2);
+}
+
+BENCHMARK(BM_TrustApplyBatch)->Arg(256)->Arg(1 << 16)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_TrustRead)->Arg(256)->Arg(1 << 16)->Arg(1 << 20);
+BENCHMARK(BM_TrustSnapshotRestore)->Arg(256)->Arg(1 << 16)->Arg(1 << 20);
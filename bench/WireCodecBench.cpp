@@ -0,0 +1,118 @@
+#include "App/Adapters/FileToRaw.h"
+#include "App/Classes/ChunkHeader.h"
+#include "BenchSupport.h"
+#include "Helper/WireCodec.h"
+#include <arpa/inet.h>
+#include <benchmark/benchmark.h>
+#include <vector>
+
+// Reference copy of the previous out-of-line helpers: runtime endianness
+// probe on every call.
+namespace legacy {
+
+[[gnu::noinline]] bool isbigEndian(){
+    uint16_t test = 0xABCD;
+    uint8_t* ptr = reinterpret_cast<uint8_t*>(&test);
+    return *ptr == 0xAB;
+}
+
+[[gnu::noinline]] void BE32(uint32_t& val){
+    if(!isbigEndian()){
+        val = htonl(val);
+    }
+}
+
+[[gnu::noinline]] void BE64(uint64_t& val){
+    if(isbigEndian()) return;
+    uint64_t hi = htonl(static_cast<uint32_t>(val >> 32));
+    uint64_t lo = htonl(static_cast<uint32_t>(val & 0xFFFFFFFF));
+    val = (lo << 32) | hi;
+}
+
+}
+
+static void BM_LegacyBE64Array(benchmark::State& state){
+    std::vector<uint64_t> values(state.range(0), 0x0102030405060708);
+    LatencyRecorder latency;
+    for(auto _ : state){
+        latency.timed([&]{
+            for(uint64_t& v : values){
+                legacy::BE64(v);
+            }
+            benchmark::ClobberMemory();
+        });
+    }
+    latency.report(state);
+    state.SetBytesProcessed(state.iterations() * state.range(0) * 8);
+}
+
+static void BM_CodecBE64Array(benchmark::State& state){
+    std::vector<uint64_t> values(state.range(0), 0x0102030405060708);
+    std::vector<uint8_t> wire(values.size() * 8);
+    LatencyRecorder latency;
+    for(auto _ : state){
+        latency.timed([&]{
+            storeBE<uint64_t>(wire.data(), values);
+            benchmark::ClobberMemory();
+        });
+    }
+    latency.report(state);
+    state.SetBytesProcessed(state.iterations() * state.range(0) * 8);
+}
+
+static void BM_LegacyChunkHeader(benchmark::State& state){
+    uint8_t wire[kChunkHeaderSize];
+    ChunkHeader header{7, 0, 1 << 20, 1456, 1, 0};
+    for(auto _ : state){
+        uint32_t transferId = header.transferId, seq = header.seq, count = header.count;
+        uint16_t chunkSize = htons(header.chunkSize);
+        legacy::BE32(transferId);
+        legacy::BE32(seq);
+        legacy::BE32(count);
+        memcpy(wire, &transferId, 4);
+        memcpy(wire + 4, &seq, 4);
+        memcpy(wire + 8, &count, 4);
+        memcpy(wire + 12, &chunkSize, 2);
+        wire[14] = header.headerChunks;
+        wire[15] = header.flags;
+        benchmark::DoNotOptimize(wire);
+        ++header.seq;
+    }
+}
+
+static void BM_CodecChunkHeader(benchmark::State& state){
+    uint8_t wire[kChunkHeaderSize];
+    ChunkHeader header{7, 0, 1 << 20, 1456, 1, 0};
+    for(auto _ : state){
+        encodeChunkHeader(header, wire);
+        benchmark::DoNotOptimize(wire);
+        ++header.seq;
+    }
+}
+
+static void BM_CodecChunkHeaderDecode(benchmark::State& state){
+    uint8_t wire[kChunkHeaderSize];
+    encodeChunkHeader(ChunkHeader{7, 9, 1 << 20, 1456, 1, 0}, wire);
+    for(auto _ : state){
+        benchmark::DoNotOptimize(wire);
+        ChunkHeader header = decodeChunkHeader(wire);
+        benchmark::DoNotOptimize(header);
+    }
+}
+
+static void BM_CodecRawHeader(benchmark::State& state){
+    File file{"capture", "pcap", 1 << 30, nullptr};
+    std::vector<uint8_t> header(rawHeaderSize(file));
+    File parsed;
+    for(auto _ : state){
+        encodeRawHeader(file, header.data());
+        benchmark::DoNotOptimize(parseRawHeader(header, parsed));
+    }
+}
+
+BENCHMARK(BM_LegacyBE64Array)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK(BM_CodecBE64Array)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK(BM_LegacyChunkHeader);
+BENCHMARK(BM_CodecChunkHeader);
+BENCHMARK(BM_CodecChunkHeaderDecode);
+BENCHMARK(BM_CodecRawHeader);
@@ -0,0 +1,51 @@
+#include "Memory/BufferPool.h"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+// Each test runs on a fresh thread so its cache binds to the test's pool.
+TEST(BufferPool, CachedSlabsAreNotInUse){
+    BufferPool pool(64, 1);
+    std::thread([&]{
+        std::vector<BufferHandle> handles;
+        for(int i = 0; i < 50; ++i){
+            handles.push_back(pool.alloc(256));
+        }
+        BufferPoolStats held = pool.stats();
+        EXPECT_EQ(held.inUse, 50u);
+        EXPECT_EQ(held.hits, 50u);
+        EXPECT_EQ(held.cached, 0u);
+
+        handles.clear();
+        BufferPoolStats freed = pool.stats();
+        EXPECT_EQ(freed.inUse, 0u);
+        EXPECT_GT(freed.cached, 0u);
+        EXPECT_EQ(freed.highWater, 50u);
+
+        // Served from the thread cache, still counted as hits.
+        BufferHandle again = pool.alloc(256);
+        EXPECT_EQ(pool.stats().hits, 51u);
+        EXPECT_EQ(pool.stats().inUse, 1u);
+    }).join();
+
+    // The exiting thread hands its slabs and hit count back.
+    BufferPoolStats after = pool.stats();
+    EXPECT_EQ(after.inUse, 0u);
+    EXPECT_EQ(after.cached, 0u);
+    EXPECT_EQ(after.hits, 51u);
+}
+
+TEST(BufferPool, OversizedAndExhaustedAllocsAreMisses){
+    BufferPool pool(2, 1);
+    std::thread([&]{
+        BufferHandle a = pool.alloc(4096);
+        BufferHandle b = pool.alloc(4096);
+        BufferHandle c = pool.alloc(4096);   // class exhausted
+        BufferHandle d = pool.alloc(8192);   // oversized
+        BufferPoolStats s = pool.stats();
+        EXPECT_EQ(s.hits, 2u);
+        EXPECT_EQ(s.misses, 2u);
+        EXPECT_EQ(s.inUse, 2u);
+        EXPECT_FALSE(pool.owns(c.data()));
+    }).join();
+}
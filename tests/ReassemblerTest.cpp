@@ -0,0 +1,106 @@
+#include "App/AppLayer.h"
+#include "App/Chunking/Reassembler.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr size_t kChunk = kDefaultMtu - kChunkHeaderSize;
+
+std::vector<uint8_t> makePayload(size_t size){
+    std::vector<uint8_t> payload(size);
+    for(size_t i = 0; i < size; ++i){
+        payload[i] = static_cast<uint8_t>(i * 7 + i / 256);
+    }
+    return payload;
+}
+
+ChunkStatus feed(Reassembler& reassembler, const MessageChunksList& list, uint32_t seq){
+    Message chunk = chunkAt(list, seq);
+    return reassembler.accept(chunkHeaderAt(list, seq), {static_cast<const uint8_t*>(chunk.data), chunk.size});
+}
+
+}
+
+TEST(Reassembler, ShuffledArrivalRoundTrips){
+    for(size_t size : {size_t{0}, size_t{1}, 3 * kChunk, 3 * kChunk + 1}){
+        std::vector<uint8_t> payload = makePayload(size);
+        File file{"capture", "pcap", payload.size(), payload.data()};
+        ChunkList list = sendData(file, 1, 2);
+        ASSERT_TRUE(list) << size;
+
+        std::vector<uint32_t> order(list->count);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), std::mt19937(static_cast<uint32_t>(size)));
+
+        std::vector<uint8_t> received(size);
+        MemorySink sink(received);
+        Reassembler reassembler(chunkHeaderAt(*list, order.back()), sink);
+        ASSERT_TRUE(reassembler.valid()) << size;
+        for(uint32_t seq : order){
+            ASSERT_EQ(feed(reassembler, *list, seq), ChunkStatus::Accepted) << size << " seq " << seq;
+        }
+        EXPECT_TRUE(reassembler.complete()) << size;
+        EXPECT_EQ(reassembler.nextMissing(), reassembler.count());
+        EXPECT_EQ(reassembler.payloadSize(), size);
+        EXPECT_EQ(received, payload) << size;
+    }
+}
+
+TEST(Reassembler, DuplicateChunkIsReportedOnce){
+    std::vector<uint8_t> payload = makePayload(2 * kChunk + 10);
+    File file{"capture", "pcap", payload.size(), payload.data()};
+    ChunkList list = sendData(file, 1, 2);
+    std::vector<uint8_t> received(payload.size());
+    MemorySink sink(received);
+    Reassembler reassembler(chunkHeaderAt(*list, 0), sink);
+
+    uint32_t last = list->count - 1;
+    EXPECT_EQ(feed(reassembler, *list, last), ChunkStatus::Accepted);
+    EXPECT_EQ(feed(reassembler, *list, last), ChunkStatus::Duplicate);
+    EXPECT_EQ(reassembler.received(), 1u);
+    EXPECT_EQ(reassembler.nextMissing(), 0u);
+}
+
+TEST(Reassembler, ShortChunkBeforeTheEndIsInvalid){
+    std::vector<uint8_t> payload = makePayload(3 * kChunk);
+    File file{"capture", "pcap", payload.size(), payload.data()};
+    ChunkList list = sendData(file, 1, 2);
+    std::vector<uint8_t> received(payload.size());
+    MemorySink sink(received);
+    Reassembler reassembler(chunkHeaderAt(*list, 0), sink);
+
+    uint32_t seq = list->headerChunks;   // first data chunk, not the last
+    Message chunk = chunkAt(*list, seq);
+    std::span<const uint8_t> bytes(static_cast<const uint8_t*>(chunk.data), chunk.size);
+    EXPECT_EQ(reassembler.accept(chunkHeaderAt(*list, seq), bytes.first(bytes.size() - 1)),
+              ChunkStatus::Invalid);
+    EXPECT_EQ(reassembler.accept(chunkHeaderAt(*list, seq), {}), ChunkStatus::Invalid);
+    EXPECT_EQ(reassembler.received(), 0u);
+    EXPECT_EQ(feed(reassembler, *list, seq), ChunkStatus::Accepted);
+}
+
+TEST(Reassembler, GeometryOverTheLimitsIsRejected){
+    MemorySink sink({});
+    ReassemblerLimits limits;
+    ChunkHeader header{9, 0, limits.maxChunks + 1, 1456, 1, 0};
+    Reassembler tooMany(header, sink, limits);
+    EXPECT_FALSE(tooMany.valid());
+    EXPECT_EQ(tooMany.accept(header, std::vector<uint8_t>(1456)), ChunkStatus::Invalid);
+    EXPECT_FALSE(tooMany.complete());
+
+    header = ChunkHeader{9, 0, 300, 1456, 200, 0};   // 291 KB of header
+    EXPECT_FALSE(Reassembler(header, sink, limits).valid());
+
+    header = ChunkHeader{9, 0, 4, 1456, 5, 0};       // more header chunks than chunks
+    EXPECT_FALSE(Reassembler(header, sink, limits).valid());
+
+    header = ChunkHeader{9, 0, 4, 1456, 1, 0};
+    limits.maxChunks = 3;
+    EXPECT_FALSE(Reassembler(header, sink, limits).valid());
+    limits.maxChunks = 4;
+    EXPECT_TRUE(Reassembler(header, sink, limits).valid());
+}
@@ -0,0 +1,99 @@
+#include "Chain/ReplayIndex.h"
+#include <gtest/gtest.h>
+
+TEST(ReplayIndex, RejectsDuplicatesInsideAndBehindTheWindow){
+    ReplayIndex index;
+    for(uint32_t seq = 0; seq < 3 * ReplayIndex::kWindow; ++seq){
+        ASSERT_TRUE(index.insert({1, 2, 7, seq}));
+    }
+    EXPECT_FALSE(index.insert({1, 2, 7, 3 * ReplayIndex::kWindow - 1}));   // in the window
+    EXPECT_FALSE(index.insert({1, 2, 7, 5}));                               // in the filter
+    EXPECT_TRUE(index.contains({1, 2, 7, 5}));
+    EXPECT_FALSE(index.contains({1, 2, 8, 5}));
+}
+
+TEST(ReplayIndex, CatchesReplayAfterFlowIsEvictedAndReclaimed){
+    ReplayIndexConfig config;
+    config.flowCapacity = 1;
+    ReplayIndex index(config);
+    for(uint32_t seq = 0; seq <= 100; ++seq){
+        ASSERT_TRUE(index.insert({1, 2, 7, seq}));
+    }
+    ASSERT_TRUE(index.insert({3, 4, 9, 0}));   // evicts (1, 2, 7)
+    ASSERT_TRUE(index.insert({1, 2, 7, 101}));  // reclaims it with an empty window
+
+    EXPECT_TRUE(index.contains({1, 2, 7, 50}));
+    EXPECT_FALSE(index.insert({1, 2, 7, 50}));
+    EXPECT_TRUE(index.insert({1, 2, 7, 102}));
+    EXPECT_FALSE(index.insert({1, 2, 7, 102}));
+}
+
+TEST(ReplayIndex, CatchesReplayAboveTheReclaimPoint){
+    ReplayIndexConfig config;
+    config.flowCapacity = 1;
+    ReplayIndex index(config);
+    for(uint32_t seq = 0; seq <= 500; ++seq){
+        if(seq != 101){
+            ASSERT_TRUE(index.insert({1, 2, 7, seq}));
+        }
+    }
+    ASSERT_TRUE(index.insert({3, 4, 9, 0}));   // evicts (1, 2, 7)
+    ASSERT_TRUE(index.insert({1, 2, 7, 101}));  // the lost chunk's retransmit reclaims it
+
+    EXPECT_TRUE(index.contains({1, 2, 7, 200}));
+    EXPECT_TRUE(index.contains({1, 2, 7, 450}));
+    EXPECT_FALSE(index.insert({1, 2, 7, 200}));
+    EXPECT_FALSE(index.insert({1, 2, 7, 450}));
+    EXPECT_FALSE(index.insert({1, 2, 7, 101}));
+    EXPECT_FALSE(index.contains({1, 2, 7, 501}));
+    EXPECT_TRUE(index.insert({1, 2, 7, 501}));
+
+    // The mark survives a checkpoint.
+    ReplayIndex restored(config);
+    ASSERT_TRUE(restored.restore(index.serialize()));
+    EXPECT_FALSE(restored.insert({1, 2, 7, 300}));
+    EXPECT_TRUE(restored.insert({1, 2, 7, 502}));
+}
+
+TEST(ReplayIndex, NewFlowsSkipTheFilterOnWindowMisses){
+    ReplayIndexConfig config;
+    config.flowCapacity = 1;
+    ReplayIndex index(config);
+    ASSERT_TRUE(index.insert({1, 2, 7, 10}));
+    // Never evicted, so seqs around the first one are simply new.
+    EXPECT_FALSE(index.contains({1, 2, 7, 5}));
+    EXPECT_TRUE(index.insert({1, 2, 7, 5}));
+    EXPECT_TRUE(index.insert({1, 2, 7, 11}));
+}
+
+TEST(ReplayIndex, RestoreKeepsFlowsAndFilter){
+    ReplayIndexConfig config;
+    config.flowCapacity = 1;
+    ReplayIndex index(config);
+    for(uint32_t seq = 0; seq < 10; ++seq){
+        index.insert({1, 2, 7, seq});
+    }
+    index.insert({3, 4, 9, 0});
+    index.insert({1, 2, 7, 10});
+
+    ReplayIndex restored(config);
+    ASSERT_TRUE(restored.restore(index.serialize()));
+    EXPECT_FALSE(restored.insert({1, 2, 7, 10}));
+    EXPECT_FALSE(restored.insert({1, 2, 7, 3}));
+    EXPECT_FALSE(restored.insert({3, 4, 9, 0}));
+    EXPECT_TRUE(restored.insert({1, 2, 7, 11}));
+}
+
+TEST(ReplayIndex, InvalidConfigRejectsEveryKey){
+    ReplayIndexConfig config;
+    config.flowCapacity = 3;
+    ReplayIndex index(config);
+    EXPECT_FALSE(index.valid());
+    EXPECT_FALSE(index.insert({1, 2, 7, 0}));
+    EXPECT_FALSE(index.contains({1, 2, 7, 0}));
+
+    config = {};
+    config.bloomBits = 32;
+    EXPECT_FALSE(ReplayIndex(config).valid());
+    EXPECT_TRUE(ReplayIndex().valid());
+}
@@ -0,0 +1,108 @@
+#include "Routing/RouteCache.h"
+#include "Routing/TopologyGenerator.h"
+#include "Trust/TrustDiary.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+RouteCache makeCache(const Topology& topology){
+    RouteCache cache(RouteGraph(topology.nodes, topology.links), 0);
+    for(uint32_t node = 0; node < topology.nodes; ++node){
+        cache.setTrust(node, topology.trust[node]);
+    }
+    return cache;
+}
+
+// Every cost must match a full recompute, and every route must be a chain of
+// live links whose weights add up to the destination's cost.
+void expectMatchesRecompute(const RouteCache& cache){
+    RouteCache fresh = cache;
+    fresh.recompute();
+    const RouteGraph& graph = cache.graph();
+    std::vector<uint32_t> hops(graph.nodes());
+    for(uint32_t node = 0; node < graph.nodes(); ++node){
+        ASSERT_EQ(cache.cost(node), fresh.cost(node)) << "node " << node;
+        if(node == cache.source() || !cache.reachable(node)){
+            continue;
+        }
+        size_t n = cache.route(node, hops);
+        ASSERT_GT(n, 0u) << "node " << node;
+        ASSERT_EQ(hops[n - 1], node);
+        uint64_t sum = 0;
+        uint32_t from = cache.source();
+        for(size_t i = 0; i < n; ++i){
+            uint32_t edge = graph.find(from, hops[i]);
+            ASSERT_LT(edge, graph.edges());
+            ASSERT_GT(graph.quality(edge), 0.0f);
+            sum += graph.arc(edge).weight;
+            from = hops[i];
+        }
+        ASSERT_EQ(sum, cache.cost(node)) << "node " << node;
+    }
+}
+
+}
+
+TEST(RouteCache, IncrementalRepairsMatchRecompute){
+    Topology topology = generateTopology(TopologyConfig{400, 6.0, 7});
+    RouteCache cache = makeCache(topology);
+    expectMatchesRecompute(cache);
+
+    SplitMix64 rng{11};
+    for(int step = 0; step < 300; ++step){
+        if(rng.next() % 2){
+            cache.setTrust(static_cast<uint32_t>(rng.next() % topology.nodes), rng.unit());
+        }else{
+            const Link& link = topology.links[rng.next() % topology.links.size()];
+            // A fifth of the changes take the link down, the rest move its quality.
+            double quality = rng.next() % 5 == 0 ? 0.0 : rng.unit();
+            cache.setLinkQuality(link.from, link.to, quality);
+        }
+        expectMatchesRecompute(cache);
+        if(HasFatalFailure()){
+            FAIL() << "diverged at step " << step;
+        }
+    }
+}
+
+TEST(RouteCache, TrustSyncMatchesRecompute){
+    Topology topology = generateTopology(TopologyConfig{400, 6.0, 3});
+    RouteCache cache = makeCache(topology);
+    TrustDiary diary(topology.nodes);
+
+    SplitMix64 rng{5};
+    for(int round = 0; round < 20; ++round){
+        std::vector<TrustOutcome> outcomes;
+        for(int i = 0; i < 100; ++i){
+            uint32_t node = static_cast<uint32_t>(rng.next() % topology.nodes);
+            uint16_t sent = static_cast<uint16_t>(rng.next() % 20);
+            uint16_t dropped = static_cast<uint16_t>(rng.next() % 20);
+            outcomes.push_back(TrustOutcome{node, sent, dropped});
+        }
+        diary.applyBatch(outcomes);
+        diary.advanceEpoch();
+        cache.syncTrust(diary);
+        expectMatchesRecompute(cache);
+        if(HasFatalFailure()){
+            FAIL() << "diverged at round " << round;
+        }
+    }
+}
+
+TEST(RouteCache, OutOfRangeInputIsIgnored){
+    const Link links[] = {{0, 1, 1.0f}, {1, 2, 1.0f}, {2, 7, 1.0f}, {9, 0, 1.0f}, {0, 2, 0.5f}};
+    RouteGraph graph(3, links);
+    ASSERT_EQ(graph.edges(), 3u);
+    EXPECT_EQ(graph.find(9, 0), graph.edges());
+
+    RouteCache cache(graph, 0);
+    uint64_t cost = cache.cost(2);
+    cache.setTrust(3, 0.1);
+    cache.setTrust(~0u, 0.1);
+    cache.setLinkQuality(9, 0, 0.0);
+    cache.setLinkQuality(2, 7, 0.0);
+    EXPECT_EQ(cache.cost(2), cost);
+    expectMatchesRecompute(cache);
+}
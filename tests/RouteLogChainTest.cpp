@@ -0,0 +1,205 @@
+#include "Chain/RouteLogChain.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Hop-less records are 34 bytes on disk after the 16-byte segment header.
+constexpr uint64_t kHeader = 16;
+constexpr uint64_t kRecord = 34;
+
+class RouteLogChainTest : public testing::Test{
+protected:
+    void SetUp() override{
+        dir_ = (std::filesystem::temp_directory_path()
+                / ("babe_routelog_" + std::string(testing::UnitTest::GetInstance()->current_test_info()->name())))
+                   .string();
+        std::filesystem::remove_all(dir_);
+    }
+    void TearDown() override{ std::filesystem::remove_all(dir_); }
+
+    std::string path(uint64_t number, const char* suffix) const{
+        char name[40];
+        snprintf(name, sizeof(name), "route-%08llu%s", static_cast<unsigned long long>(number), suffix);
+        return dir_ + "/" + name;
+    }
+
+    std::vector<uint8_t> readFile(const std::string& file) const{
+        std::ifstream in(file, std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), {});
+    }
+
+    void patch(const std::string& file, uint64_t offset, std::vector<uint8_t> bytes) const{
+        std::fstream out(file, std::ios::binary | std::ios::in | std::ios::out);
+        out.seekp(static_cast<std::streamoff>(offset));
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    static RouteLogConfig smallSegments(uint32_t recordsPerSegment, uint32_t blockRecords){
+        RouteLogConfig config;
+        config.segmentBytes = kHeader + recordsPerSegment * kRecord;
+        config.blockRecords = blockRecords;
+        config.syncOnSeal = false;
+        return config;
+    }
+
+    static RouteRecord record(uint32_t seq){ return RouteRecord{1, 2, 7, seq, seq, 0, {}}; }
+
+    std::string dir_;
+};
+
+}
+
+TEST_F(RouteLogChainTest, TornTailIsZeroedAndAppendsContinue){
+    RouteLogConfig config = smallSegments(64, 4);
+    {
+        RouteLogChain chain(dir_, config);
+        ASSERT_TRUE(chain.isOpen());
+        for(uint32_t seq = 0; seq < 10; ++seq){
+            ASSERT_EQ(chain.log(record(seq)), LogResult::Logged);
+        }
+    }
+    // A half-written record (bad checksum) plus stray bytes written back past it.
+    uint64_t tail = kHeader + 10 * kRecord;
+    patch(path(0, ".seg"), tail, {0, 0, 0, 25, 1, 0xAA, 0xBB});
+    patch(path(0, ".seg"), tail + 200, {0xCC, 0xDD});
+
+    {
+        RouteLogChain chain(dir_, config);
+        ASSERT_TRUE(chain.isOpen());
+        EXPECT_EQ(chain.recovery().recordsReplayed, 10u);
+        std::vector<uint8_t> bytes = readFile(path(0, ".seg"));
+        for(uint64_t i = tail; i < bytes.size(); ++i){
+            ASSERT_EQ(bytes[i], 0) << "offset " << i;
+        }
+        EXPECT_TRUE(chain.seen(replayKey(record(9))));
+        EXPECT_EQ(chain.log(record(9)), LogResult::Replay);
+        EXPECT_EQ(chain.log(record(10)), LogResult::Logged);
+    }
+    RouteLogChain chain(dir_, config);
+    EXPECT_EQ(chain.recovery().recordsReplayed, 11u);
+}
+
+TEST_F(RouteLogChainTest, BadRecordInSealedBlockSkipsToTheBlockEnd){
+    RouteLogConfig config = smallSegments(64, 4);
+    {
+        RouteLogChain chain(dir_, config);
+        for(uint32_t seq = 0; seq < 12; ++seq){
+            ASSERT_EQ(chain.log(record(seq)), LogResult::Logged);
+        }
+        ASSERT_EQ(chain.sealPending(), 3u);
+        EXPECT_TRUE(chain.verify());
+    }
+    // Flip a byte in the body of record 5, inside the second block.
+    uint64_t offset = kHeader + 5 * kRecord + 10;
+    uint8_t byte = readFile(path(0, ".seg"))[offset];
+    patch(path(0, ".seg"), offset, {static_cast<uint8_t>(byte ^ 0xFF)});
+
+    RouteLogChain chain(dir_, config);
+    ASSERT_TRUE(chain.isOpen());
+    // Records before the damage are intact; the rest of that block is skipped.
+    EXPECT_EQ(chain.recovery().recordsReplayed, 9u);
+    EXPECT_TRUE(chain.seen(replayKey(record(4))));
+    EXPECT_FALSE(chain.seen(replayKey(record(5))));
+    EXPECT_FALSE(chain.seen(replayKey(record(7))));
+    EXPECT_TRUE(chain.seen(replayKey(record(11))));
+    EXPECT_FALSE(chain.verify());
+    // The log still ends after record 11, not at the damage.
+    EXPECT_EQ(chain.log(record(11)), LogResult::Replay);
+    EXPECT_EQ(chain.log(record(12)), LogResult::Logged);
+}
+
+TEST_F(RouteLogChainTest, CheckpointReplaysOnlyLaterSegments){
+    RouteLogConfig config = smallSegments(4, 4);
+    {
+        RouteLogChain chain(dir_, config);
+        for(uint32_t seq = 0; seq < 20; ++seq){
+            ASSERT_EQ(chain.log(record(seq)), LogResult::Logged);
+        }
+    }
+    // Five segments; checkpoints of the two before the active one remain.
+    ASSERT_TRUE(std::filesystem::exists(path(4, ".seg")));
+    ASSERT_TRUE(std::filesystem::exists(path(3, ".idx")));
+    ASSERT_TRUE(std::filesystem::exists(path(2, ".idx")));
+    EXPECT_FALSE(std::filesystem::exists(path(1, ".idx")));
+
+    RouteLogChain chain(dir_, config);
+    EXPECT_TRUE(chain.recovery().fromCheckpoint);
+    EXPECT_EQ(chain.recovery().recordsReplayed, 4u);
+    for(uint32_t seq = 0; seq < 20; ++seq){
+        EXPECT_TRUE(chain.seen(replayKey(record(seq)))) << seq;
+    }
+}
+
+TEST_F(RouteLogChainTest, DamagedCheckpointFallsBackToThePreviousOne){
+    RouteLogConfig config = smallSegments(4, 4);
+    {
+        RouteLogChain chain(dir_, config);
+        for(uint32_t seq = 0; seq < 20; ++seq){
+            ASSERT_EQ(chain.log(record(seq)), LogResult::Logged);
+        }
+    }
+    std::vector<uint8_t> idx = readFile(path(3, ".idx"));
+    patch(path(3, ".idx"), idx.size() - 1, {static_cast<uint8_t>(idx.back() ^ 1)});
+
+    RouteLogChain chain(dir_, config);
+    ASSERT_TRUE(chain.isOpen());
+    EXPECT_TRUE(chain.recovery().fromCheckpoint);
+    EXPECT_EQ(chain.recovery().recordsReplayed, 8u);
+    for(uint32_t seq = 0; seq < 20; ++seq){
+        EXPECT_TRUE(chain.seen(replayKey(record(seq)))) << seq;
+    }
+    EXPECT_EQ(chain.log(record(7)), LogResult::Replay);
+}
+
+TEST_F(RouteLogChainTest, SealingResumesAfterTheLastFinalEntry){
+    RouteLogConfig config = smallSegments(4, 2);
+    Sha256Digest head;
+    uint64_t blocks;
+    {
+        RouteLogChain chain(dir_, config);
+        for(uint32_t seq = 0; seq < 10; ++seq){
+            ASSERT_EQ(chain.log(record(seq)), LogResult::Logged);
+        }
+        ASSERT_EQ(chain.sealPending(), 5u);
+        head = chain.head();
+        blocks = chain.blocks();
+        ASSERT_TRUE(chain.verify());
+    }
+
+    RouteLogChain chain(dir_, config);
+    ASSERT_TRUE(chain.isOpen());
+    // Segments 0 and 1 are closed by final entries; only the active one is opened.
+    EXPECT_EQ(chain.recovery().segmentsScanned, 1u);
+    EXPECT_EQ(chain.head(), head);
+    EXPECT_EQ(chain.blocks(), blocks);
+    EXPECT_TRUE(chain.verify());
+
+    EXPECT_EQ(chain.log(record(10)), LogResult::Logged);
+    EXPECT_EQ(chain.log(record(11)), LogResult::Logged);
+    EXPECT_EQ(chain.sealPending(), 1u);
+    EXPECT_EQ(chain.blocks(), blocks + 1);
+    EXPECT_NE(chain.head(), head);
+    EXPECT_TRUE(chain.verify());
+}
+
+TEST_F(RouteLogChainTest, InvalidConfigLeavesTheChainClosed){
+    RouteLogConfig config;
+    config.segmentBytes = 8;
+    EXPECT_FALSE(RouteLogChain(dir_, config).isOpen());
+
+    config = {};
+    config.blockRecords = 0;
+    EXPECT_FALSE(RouteLogChain(dir_, config).isOpen());
+
+    config = {};
+    config.index.flowCapacity = 1000;
+    RouteLogChain chain(dir_, config);
+    EXPECT_FALSE(chain.isOpen());
+    EXPECT_EQ(chain.log(record(0)), LogResult::Failed);
+    EXPECT_EQ(chain.sealPending(), 0u);
+}
@@ -0,0 +1,131 @@
+#include "App/AppLayer.h"
+#include "App/Chunking/Reassembler.h"
+#include "App/Streaming/FileSink.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+class StreamingTest : public testing::Test{
+protected:
+    void SetUp() override{
+        dir_ = (std::filesystem::temp_directory_path()
+                / ("babe_streaming_" + std::string(testing::UnitTest::GetInstance()->current_test_info()->name())))
+                   .string();
+        std::filesystem::remove_all(dir_);
+        std::filesystem::create_directories(dir_);
+    }
+    void TearDown() override{ std::filesystem::remove_all(dir_); }
+
+    std::string writeSource(size_t size) const{
+        std::string file = dir_ + "/source";
+        std::ofstream out(file, std::ios::binary);
+        for(size_t i = 0; i < size; ++i){
+            out.put(static_cast<char>(pattern(i)));
+        }
+        return file;
+    }
+
+    std::vector<uint8_t> readFile(const std::string& file) const{
+        std::ifstream in(file, std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), {});
+    }
+
+    static uint8_t pattern(size_t i){ return static_cast<uint8_t>(i * 31 + i / 251); }
+
+    std::string dir_;
+};
+
+}
+
+TEST_F(StreamingTest, MappedFileSourceSlidesItsWindow){
+    std::string file = writeSource(20000);
+    MappedFileSource source(file.c_str(), 4096);
+    ASSERT_TRUE(source.isOpen());
+    EXPECT_EQ(source.size(), 20000u);
+
+    // Inside one window, straddling two, and the tail of the file.
+    for(uint64_t offset : {0u, 100u, 4000u, 8190u, 19990u}){
+        const uint8_t* bytes = source.map(offset, 10);
+        ASSERT_NE(bytes, nullptr) << offset;
+        for(size_t i = 0; i < 10; ++i){
+            ASSERT_EQ(bytes[i], pattern(offset + i)) << offset + i;
+        }
+    }
+    EXPECT_EQ(source.map(19995, 10), nullptr);
+    EXPECT_EQ(source.map(20001, 0), nullptr);
+    EXPECT_FALSE(MappedFileSource((dir_ + "/missing").c_str()).isOpen());
+}
+
+TEST_F(StreamingTest, FileSinkCoalescesRunsAndTrims){
+    std::string file = dir_ + "/sink";
+    std::vector<uint8_t> expected(10000);
+    for(size_t i = 0; i < expected.size(); ++i){
+        expected[i] = pattern(i);
+    }
+    {
+        FileSink sink(file.c_str(), 1024);
+        ASSERT_TRUE(sink.isOpen());
+        std::span<const uint8_t> bytes(expected);
+        // A run of small writes, one larger than the buffer, then out of order.
+        for(size_t offset = 0; offset < 3000; offset += 500){
+            ASSERT_TRUE(sink.write(offset, bytes.subspan(offset, 500)));
+        }
+        ASSERT_TRUE(sink.write(3000, bytes.subspan(3000, 4000)));
+        ASSERT_TRUE(sink.write(9000, bytes.subspan(9000, 1000)));
+        ASSERT_TRUE(sink.write(7000, bytes.subspan(7000, 2000)));
+        ASSERT_TRUE(sink.write(10000, bytes.subspan(0, 100)));   // past the end, trimmed below
+        ASSERT_TRUE(sink.finish(expected.size()));
+    }
+    EXPECT_EQ(readFile(file), expected);
+    EXPECT_FALSE(FileSink((dir_ + "/no/such/dir").c_str()).isOpen());
+}
+
+TEST_F(StreamingTest, StreamToDiskRoundTrips){
+    std::string file = writeSource(100000);
+    std::string out = dir_ + "/out";
+    MappedFileSource source(file.c_str(), 16384);
+    File meta{"capture", "pcap", 0, nullptr};
+    ChunkStream stream = sendStream(meta, source, 1, 2);
+    ASSERT_TRUE(stream.valid());
+    {
+        FileSink sink(out.c_str(), 4096);
+        Reassembler reassembler(chunkHeaderAt(stream.list(), 0), sink);
+        Message batch[16];
+        while(size_t n = stream.next(batch)){
+            for(size_t i = 0; i < n; ++i){
+                ASSERT_EQ(reassembler.accept(chunkHeaderAt(stream.list(), batch[i].SeqNum),
+                                             {static_cast<const uint8_t*>(batch[i].data), batch[i].size}),
+                          ChunkStatus::Accepted);
+            }
+        }
+        EXPECT_FALSE(stream.failed());
+        ASSERT_TRUE(reassembler.complete());
+        ASSERT_TRUE(sink.finish(reassembler.payloadSize()));
+    }
+    EXPECT_EQ(readFile(out), readFile(file));
+}
+
+TEST_F(StreamingTest, UnreadableSourceStopsTheStream){
+    std::string file = writeSource(100000);
+    MappedFileSource source(file.c_str(), 16384);
+    File meta{"capture", "pcap", 0, nullptr};
+    ChunkStream stream = sendStream(meta, source, 1, 2);
+    ASSERT_TRUE(stream.valid());
+    uint32_t firstData = stream.list().headerChunks;
+
+    // Header chunks need no source; the first batch reaching data fails whole.
+    std::vector<Message> header(firstData);
+    ASSERT_EQ(stream.next(header), firstData);
+    MappedFileSource closed = std::move(source);   // leaves the stream's source without a file
+    Message batch[16];
+    EXPECT_EQ(stream.next(batch), 0u);
+    EXPECT_TRUE(stream.failed());
+    EXPECT_TRUE(stream.done());
+    Message chunk = stream.at(firstData);
+    EXPECT_EQ(chunk.size, 0u);
+    EXPECT_EQ(chunk.data, nullptr);
+}
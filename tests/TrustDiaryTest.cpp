@@ -0,0 +1,120 @@
+#include "Trust/TrustDiary.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+void recordMany(TrustDiary& diary, uint32_t node, uint16_t forwarded, uint16_t dropped){
+    TrustOutcome outcome{node, forwarded, dropped};
+    diary.applyBatch({&outcome, 1});
+}
+
+}
+
+TEST(TrustDiary, WordStampedAheadReadsAsFresh){
+    TrustDiary diary;
+    diary.advanceEpoch(10);
+    recordMany(diary, 3, 90, 10);
+    double fresh = diary.trust(3);
+
+    // A reader still on epoch 5 sees a word a racing writer stamped with 10.
+    std::vector<uint8_t> image = diary.snapshot();
+    image[7] = 5;
+    TrustDiary behind;
+    ASSERT_TRUE(behind.restore(image));
+    ASSERT_EQ(behind.epoch(), 5u);
+    EXPECT_DOUBLE_EQ(behind.trust(3), fresh);
+
+    // Merging on epoch 5 keeps the later stamp, so nothing decays until 11.
+    behind.record(3, true);
+    double merged = behind.trust(3);
+    behind.advanceEpoch(5);
+    EXPECT_DOUBLE_EQ(behind.trust(3), merged);
+    behind.advanceEpoch();
+    EXPECT_LT(behind.trust(3), merged);
+}
+
+TEST(TrustDiary, EvidenceIsGoneAfterTheEpochRingWraps){
+    TrustDiary diary;
+    recordMany(diary, 1, 100, 0);
+    for(uint32_t i = 0; i < (1u << 20); ++i){
+        diary.advanceEpoch();
+    }
+    EXPECT_DOUBLE_EQ(diary.trust(1), 0.5);
+
+    recordMany(diary, 1, 100, 0);
+    diary.advanceEpoch(1u << 20);
+    EXPECT_DOUBLE_EQ(diary.trust(1), 0.5);
+}
+
+TEST(TrustDiary, LongJumpsClearEverything){
+    TrustDiary diary;
+    recordMany(diary, 1, 100, 0);
+    recordMany(diary, 2, 0, 100);
+    diary.advanceEpoch(1u << 16);
+    EXPECT_DOUBLE_EQ(diary.trust(1), 0.5);
+    EXPECT_DOUBLE_EQ(diary.trust(2), 0.5);
+
+    TrustConfig slow;
+    slow.decayPerEpoch = 0.9999;
+    TrustDiary patient(256, slow);
+    recordMany(patient, 1, 1000, 0);
+    patient.advanceEpoch(1u << 20);
+    EXPECT_DOUBLE_EQ(patient.trust(1), 0.5);
+}
+
+TEST(TrustDiary, SlowDecayFadesWithoutAStep){
+    TrustConfig config;
+    config.decayPerEpoch = 0.9999;
+    TrustDiary diary(256, config);
+    recordMany(diary, 1, 10000, 0);
+    diary.advanceEpoch(65530);
+    double previous = diary.trust(1);
+    for(int i = 0; i < 12; ++i){
+        diary.advanceEpoch();
+        double now = diary.trust(1);
+        EXPECT_LE(now, previous);
+        EXPECT_NEAR(now, previous, 1e-4) << "epoch " << diary.epoch();
+        previous = now;
+    }
+    // 10000 * 0.9999^65542 is about 14 forwards still on the books.
+    EXPECT_NEAR(diary.counts(1).alpha, 1.0 + 10000 * std::pow(0.9999, 65542.0), 0.1);
+
+    config.decayPerEpoch = 0.999999;
+    EXPECT_LT(TrustDiary(1, config).config().decayPerEpoch, 0.99995);
+}
+
+TEST(TrustDiary, SaturationKeepsThePosteriorMean){
+    TrustConfig config;
+    config.decayPerEpoch = 1.0;
+    TrustDiary diary(4, config);
+    for(int i = 0; i < 8; ++i){
+        recordMany(diary, 0, 60000, 20000);
+    }
+    TrustCounts c = diary.counts(0);
+    EXPECT_LT(c.alpha, 16385.0);
+    EXPECT_NEAR(diary.trust(0), 0.75, 1e-3);
+}
+
+TEST(TrustDiary, SnapshotRoundTrips){
+    TrustDiary diary(300);
+    for(uint32_t node = 0; node < 300; node += 7){
+        recordMany(diary, node, static_cast<uint16_t>(node), static_cast<uint16_t>(300 - node));
+        diary.advanceEpoch();
+    }
+    std::vector<uint8_t> image = diary.snapshot();
+
+    TrustDiary restored(300);
+    ASSERT_TRUE(restored.restore(image));
+    EXPECT_EQ(restored.epoch(), diary.epoch());
+    for(uint32_t node = 0; node < 300; ++node){
+        ASSERT_DOUBLE_EQ(restored.trust(node), diary.trust(node)) << node;
+    }
+    EXPECT_EQ(restored.snapshot(), image);
+
+    EXPECT_FALSE(TrustDiary(256).restore(image));
+    image.pop_back();
+    EXPECT_FALSE(restored.restore(image));
+}
@@ -0,0 +1,33 @@
+#include "Helper/WireCodec.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+// Odd counts leave a scalar tail after the 16-byte vector lanes.
+template<typename T>
+void expectBulkMatchesScalar(size_t count){
+    std::vector<T> values(count);
+    for(size_t i = 0; i < count; ++i){
+        values[i] = static_cast<T>(0x0102030405060708ull * (i + 1));
+    }
+    std::vector<uint8_t> wire(count * sizeof(T));
+    storeBE<T>(wire.data(), std::span<const T>(values));
+    for(size_t i = 0; i < count; ++i){
+        ASSERT_EQ(loadBE<T>(wire.data() + i * sizeof(T)), values[i]) << i;
+    }
+    std::vector<T> back(count);
+    loadBE<T>(std::span<T>(back), wire.data());
+    EXPECT_EQ(back, values);
+}
+
+}
+
+TEST(WireCodec, BulkConversionMatchesPerField){
+    for(size_t count : {0u, 1u, 7u, 16u, 33u}){
+        expectBulkMatchesScalar<uint16_t>(count);
+        expectBulkMatchesScalar<uint32_t>(count);
+        expectBulkMatchesScalar<uint64_t>(count);
+    }
+}